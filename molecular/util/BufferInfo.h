@@ -28,6 +28,7 @@ SOFTWARE.
 
 #include <string>
 #include <ostream>
+#include <cstddef>
 #include <cstdint>
 
 namespace molecular
@@ -79,6 +80,26 @@ struct VertexAttributeInfo
 		normalized(normalized)
 	{}
 
+	/// Size of a single component of the given type in bytes
+	static size_t GetTypeSize(Type type)
+	{
+		switch(type)
+		{
+		case kInt8:
+		case kUInt8:
+			return 1;
+		case kInt16:
+		case kUInt16:
+		case kHalf:
+			return 2;
+		case kFloat:
+		case kInt32:
+		case kUInt32:
+			return 4;
+		}
+		return 0;
+	}
+
 	uint32_t semantic;
 
 	/// Data type in buffer
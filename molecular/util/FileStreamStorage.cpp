@@ -84,6 +84,13 @@ FileWriteStorage::FileWriteStorage(const std::string& filename) :
 {
 }
 
+void FileWriteStorage::Flush()
+{
+	assert(mFile);
+	if(fflush(mFile) != 0 || ferror(mFile))
+		throw std::runtime_error(std::string("Writing file failed: ") + StringUtils::StrError(errno));
+}
+
 FileWriteStorage::~FileWriteStorage()
 {
 	assert(mFile);
@@ -130,6 +130,11 @@ public:
 			throw std::runtime_error(std::string("fseek: ") + StringUtils::StrError(errno));
 	}
 
+	/// Write buffered data to the file
+	/** Write() does not report errors, so call this to check that everything was written.
+		@throw std::runtime_error if this or any previous write failed. */
+	void Flush();
+
 private:
 	FILE* mFile = nullptr;
 };
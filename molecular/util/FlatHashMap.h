@@ -0,0 +1,195 @@
+/*	FlatHashMap.h
+
+MIT License
+
+Copyright (c) 2026 Fabian Herb
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef MOLECULAR_UTIL_FLATHASHMAP_H
+#define MOLECULAR_UTIL_FLATHASHMAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace molecular
+{
+namespace util
+{
+
+/// Hash function object for FlatHashMap
+/** Specialized for integer keys. std::hash is the identity for integers
+	in common implementations, which clusters packed keys in a power-of-two
+	table. Provide a specialization or a custom function object for other
+	key types. */
+template<typename TKey>
+struct FlatHash;
+
+/// Mixes all bits of the key using the MurmurHash3 finalizer
+template<>
+struct FlatHash<uint64_t>
+{
+	size_t operator()(uint64_t key) const
+	{
+		key ^= key >> 33;
+		key *= 0xff51afd7ed558ccdULL;
+		key ^= key >> 33;
+		key *= 0xc4ceb9fe1a85ec53ULL;
+		key ^= key >> 33;
+		return size_t(key);
+	}
+};
+
+/// Mixes all bits of the key using the MurmurHash3 finalizer
+template<>
+struct FlatHash<uint32_t>
+{
+	size_t operator()(uint32_t key) const {return FlatHash<uint64_t>()(key);}
+};
+
+/// Hash map with open addressing and linear probing
+/** Keys and values are stored inline in a single power-of-two sized array,
+	so lookups touch few cache lines and inserts never allocate unless the
+	table grows. The load factor is kept at or below 3/4. Clear() is constant
+	time, so a map can be reused for many small inputs after reserving
+	once. Elements cannot be erased individually.
+	@tparam TKey Equality comparable, cheap to copy.
+	@tparam TValue Default constructible, cheap to copy. */
+template<typename TKey, typename TValue, class THash = FlatHash<TKey>>
+class FlatHashMap
+{
+public:
+	/** @param expectedSize Number of elements to reserve space for. */
+	explicit FlatHashMap(size_t expectedSize = 0)
+	{
+		Reserve(expectedSize);
+	}
+
+	/// Make room for expectedSize elements without growing
+	void Reserve(size_t expectedSize)
+	{
+		// Aim for a load factor of 1/2:
+		size_t capacity = 16;
+		while(capacity < expectedSize * 2)
+			capacity *= 2;
+		if(capacity > mSlots.size())
+			Rehash(capacity);
+	}
+
+	/// Insert element if the key is not present yet
+	/** @returns Pointer to the value stored for the key, and true if it was
+		inserted. The pointer is valid until the next insertion. */
+	std::pair<TValue*, bool> Insert(const TKey& key, const TValue& value)
+	{
+		if((mSize + 1) * 4 > mSlots.size() * 3)
+			Rehash(mSlots.size() * 2);
+
+		Slot* slot = Probe(key);
+		if(slot->generation == mGeneration)
+			return std::make_pair(&slot->value, false);
+
+		slot->key = key;
+		slot->value = value;
+		slot->generation = mGeneration;
+		mSize++;
+		return std::make_pair(&slot->value, true);
+	}
+
+	/// Look up value
+	/** @returns nullptr if the key is not present. */
+	TValue* Find(const TKey& key)
+	{
+		Slot* slot = Probe(key);
+		return (slot->generation == mGeneration) ? &slot->value : nullptr;
+	}
+
+	/// Look up value
+	/** @returns nullptr if the key is not present. */
+	const TValue* Find(const TKey& key) const
+	{
+		return const_cast<FlatHashMap*>(this)->Find(key);
+	}
+
+	/// Remove all elements, keeping the allocated memory
+	void Clear()
+	{
+		mSize = 0;
+		if(++mGeneration == 0)
+		{
+			// Generation counter wrapped around, so stale slots could appear occupied:
+			for(auto& slot: mSlots)
+				slot.generation = 0;
+			mGeneration = 1;
+		}
+	}
+
+	size_t GetSize() const {return mSize;}
+	bool IsEmpty() const {return mSize == 0;}
+
+	/// Number of slots
+	size_t GetCapacity() const {return mSlots.size();}
+
+private:
+	struct Slot
+	{
+		TKey key;
+		TValue value;
+		/// Slot is occupied if this equals mGeneration
+		uint32_t generation;
+	};
+
+	/// Find slot containing key, or the free slot where it would be inserted
+	Slot* Probe(const TKey& key)
+	{
+		const size_t mask = mSlots.size() - 1;
+		size_t i = THash()(key) & mask;
+		while(mSlots[i].generation == mGeneration && !(mSlots[i].key == key))
+			i = (i + 1) & mask;
+		return &mSlots[i];
+	}
+
+	void Rehash(size_t capacity)
+	{
+		std::vector<Slot> oldSlots(capacity, Slot{TKey(), TValue(), 0});
+		oldSlots.swap(mSlots);
+		const uint32_t oldGeneration = mGeneration;
+		mGeneration = 1;
+		for(auto& slot: oldSlots)
+		{
+			if(slot.generation == oldGeneration)
+			{
+				Slot* newSlot = Probe(slot.key);
+				*newSlot = slot;
+				newSlot->generation = mGeneration;
+			}
+		}
+	}
+
+	std::vector<Slot> mSlots;
+	size_t mSize = 0;
+	uint32_t mGeneration = 1;
+};
+
+}
+} // namespace molecular
+
+#endif // MOLECULAR_UTIL_FLATHASHMAP_H
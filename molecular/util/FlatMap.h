@@ -0,0 +1,175 @@
+/*	FlatMap.h
+
+MIT License
+
+Copyright (c) 2026 Fabian Herb
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef MOLECULAR_UTIL_FLATMAP_H
+#define MOLECULAR_UTIL_FLATMAP_H
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace molecular
+{
+namespace util
+{
+
+/// Map stored as a sorted array of key-value pairs
+/** Meant for a handful of elements: lookups search a single contiguous
+	allocation and iteration visits keys in ascending order. Follows the
+	interface of std::map, so it can replace it without changing callers.
+	Like there, keys are const, so they cannot be changed through iterators.
+	Inserting or erasing rebuilds the array and invalidates iterators and
+	references to elements.
+	@tparam TKey Less-than comparable, cheap to copy.
+	@tparam TValue Movable. */
+template<typename TKey, typename TValue>
+class FlatMap
+{
+public:
+	using key_type = TKey;
+	using mapped_type = TValue;
+	using value_type = std::pair<const TKey, TValue>;
+	using size_type = size_t;
+	using iterator = typename std::vector<value_type>::iterator;
+	using const_iterator = typename std::vector<value_type>::const_iterator;
+
+	/// Insert element if the key is not present yet
+	/** @returns Iterator to the element with the key, and true if it was inserted. */
+	template<typename... Args>
+	std::pair<iterator, bool> emplace(const TKey& key, Args&&... args)
+	{
+		iterator it = LowerBound(key);
+		if(it != mElements.end() && !(key < it->first))
+			return std::make_pair(it, false);
+
+		// Const keys cannot be assigned, so elements cannot be shifted within the array:
+		const size_t index = it - mElements.begin();
+		std::vector<value_type> elements;
+		elements.reserve(std::max(mElements.size() + 1, mElements.capacity()));
+		for(size_t i = 0; i < index; ++i)
+			elements.emplace_back(std::move(mElements[i]));
+		elements.emplace_back(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(std::forward<Args>(args)...));
+		for(size_t i = index; i < mElements.size(); ++i)
+			elements.emplace_back(std::move(mElements[i]));
+		mElements.swap(elements);
+		return std::make_pair(mElements.begin() + index, true);
+	}
+
+	/// Insert element if the key is not present yet
+	std::pair<iterator, bool> insert(value_type&& value)
+	{
+		return emplace(value.first, std::move(value.second));
+	}
+
+	/// Access element, default constructing it if not present
+	TValue& operator[](const TKey& key)
+	{
+		return emplace(key).first->second;
+	}
+
+	/// Access element
+	/** @throw std::out_of_range if the key is not present. */
+	TValue& at(const TKey& key)
+	{
+		iterator it = find(key);
+		if(it == mElements.end())
+			throw std::out_of_range("FlatMap: Key not found");
+		return it->second;
+	}
+
+	/// Access element
+	/** @throw std::out_of_range if the key is not present. */
+	const TValue& at(const TKey& key) const
+	{
+		return const_cast<FlatMap*>(this)->at(key);
+	}
+
+	iterator find(const TKey& key)
+	{
+		iterator it = LowerBound(key);
+		return (it != mElements.end() && !(key < it->first)) ? it : mElements.end();
+	}
+
+	const_iterator find(const TKey& key) const
+	{
+		return const_cast<FlatMap*>(this)->find(key);
+	}
+
+	size_t count(const TKey& key) const {return find(key) != end() ? 1 : 0;}
+
+	/// Remove element with the key
+	/** @returns Number of removed elements. */
+	size_t erase(const TKey& key)
+	{
+		iterator it = find(key);
+		if(it == mElements.end())
+			return 0;
+		erase(it);
+		return 1;
+	}
+
+	/// Remove element
+	/** @returns Iterator to the element following the removed one. */
+	iterator erase(const_iterator it)
+	{
+		const size_t index = it - mElements.cbegin();
+		std::vector<value_type> elements;
+		elements.reserve(mElements.capacity());
+		for(size_t i = 0; i < mElements.size(); ++i)
+		{
+			if(i != index)
+				elements.emplace_back(std::move(mElements[i]));
+		}
+		mElements.swap(elements);
+		return mElements.begin() + index;
+	}
+
+	void clear() {mElements.clear();}
+	void reserve(size_t size) {mElements.reserve(size);}
+	size_t size() const {return mElements.size();}
+	bool empty() const {return mElements.empty();}
+
+	iterator begin() {return mElements.begin();}
+	iterator end() {return mElements.end();}
+	const_iterator begin() const {return mElements.begin();}
+	const_iterator end() const {return mElements.end();}
+
+private:
+	iterator LowerBound(const TKey& key)
+	{
+		return std::lower_bound(mElements.begin(), mElements.end(), key,
+				[](const value_type& element, const TKey& k){return element.first < k;});
+	}
+
+	std::vector<value_type> mElements;
+};
+
+}
+} // namespace molecular
+
+#endif // MOLECULAR_UTIL_FLATMAP_H
@@ -99,6 +99,27 @@ namespace Murmur
 	{
 		return Finalize(Hash2(str, length, seed) ^ uint32_t(length));
 	}
+
+	/// Compute Hash of large data at runtime
+	/** Gives the same result as Hash(), but iterates instead of recursing, so
+		it is suitable for file contents. */
+	inline uint32_t HashData(const void* data, size_t length, uint32_t seed = 42)
+	{
+		const char* str = static_cast<const char*>(data);
+		uint32_t state = seed;
+		size_t remaining = length;
+		for(; remaining >= 4; remaining -= 4, str += 4)
+			state = Mix(ToInt32(str), state);
+
+		if(remaining == 1)
+			state ^= Mix2(str[0]);
+		else if(remaining == 2)
+			state ^= Mix2((str[1] << 8) | str[0]);
+		else if(remaining == 3)
+			state ^= Mix2((str[2] << 16) | (str[1] << 8) | str[0]);
+
+		return Finalize(state ^ uint32_t(length));
+	}
 }
 
 constexpr uint32_t operator"" _H(const char* str, size_t length)
@@ -0,0 +1,177 @@
+/*	MappedFile.cpp
+
+MIT License
+
+Copyright (c) 2026 Fabian Herb
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "MappedFile.h"
+#include "StringUtils.h"
+
+#include <cerrno>
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+	#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+	#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace molecular
+{
+namespace util
+{
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const char* filename)
+{
+	HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if(file == INVALID_HANDLE_VALUE)
+		throw std::runtime_error(std::string(filename) + " could not be opened for reading");
+	mFile = file;
+
+	LARGE_INTEGER size;
+	if(!GetFileSizeEx(file, &size))
+	{
+		Unmap();
+		throw std::runtime_error(std::string(filename) + ": Could not determine file size");
+	}
+	mSize = static_cast<size_t>(size.QuadPart);
+	if(mSize == 0)
+		return; // Empty files cannot be mapped
+
+	mMapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if(mMapping)
+		mData = MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0);
+	if(!mData)
+	{
+		Unmap();
+		throw std::runtime_error(std::string(filename) + " could not be mapped into memory");
+	}
+}
+
+void MappedFile::Unmap()
+{
+	if(mData)
+		UnmapViewOfFile(mData);
+	if(mMapping)
+		CloseHandle(mMapping);
+	if(mFile)
+		CloseHandle(mFile);
+	mData = nullptr;
+	mMapping = nullptr;
+	mFile = nullptr;
+	mSize = 0;
+}
+
+#else
+
+MappedFile::MappedFile(const char* filename)
+{
+	int file = open(filename, O_RDONLY);
+	if(file < 0)
+		throw std::runtime_error(std::string(filename) + " could not be opened for reading: " + StringUtils::StrError(errno));
+
+	struct stat status;
+	if(fstat(file, &status) != 0)
+	{
+		int error = errno;
+		close(file);
+		throw std::runtime_error(std::string(filename) + ": fstat: " + StringUtils::StrError(error));
+	}
+
+	mSize = static_cast<size_t>(status.st_size);
+	if(mSize > 0) // Empty files cannot be mapped
+	{
+		void* data = mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, file, 0);
+		if(data == MAP_FAILED)
+		{
+			int error = errno;
+			close(file);
+			throw std::runtime_error(std::string(filename) + ": mmap: " + StringUtils::StrError(error));
+		}
+		mData = data;
+	}
+	// The mapping stays valid after closing the descriptor:
+	close(file);
+}
+
+void MappedFile::Unmap()
+{
+	if(mData)
+		munmap(const_cast<void*>(mData), mSize);
+	mData = nullptr;
+	mSize = 0;
+}
+
+#endif
+
+MappedFile::MappedFile(const std::string& filename) :
+	MappedFile(filename.c_str())
+{
+}
+
+MappedFile::MappedFile(MappedFile&& that) noexcept :
+	mData(that.mData),
+	mSize(that.mSize)
+#ifdef _WIN32
+	, mFile(that.mFile),
+	mMapping(that.mMapping)
+#endif
+{
+	that.mData = nullptr;
+	that.mSize = 0;
+#ifdef _WIN32
+	that.mFile = nullptr;
+	that.mMapping = nullptr;
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+	Unmap();
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& that) noexcept
+{
+	Unmap();
+	std::swap(mData, that.mData);
+	std::swap(mSize, that.mSize);
+#ifdef _WIN32
+	std::swap(mFile, that.mFile);
+	std::swap(mMapping, that.mMapping);
+#endif
+	return *this;
+}
+
+}
+} // namespace molecular
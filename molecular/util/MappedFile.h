@@ -0,0 +1,80 @@
+/*	MappedFile.h
+
+MIT License
+
+Copyright (c) 2026 Fabian Herb
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef MOLECULAR_UTIL_MAPPEDFILE_H
+#define MOLECULAR_UTIL_MAPPEDFILE_H
+
+#include <molecular/util/NonCopyable.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace molecular
+{
+namespace util
+{
+
+/// Read-only memory mapping of an entire file
+/** Movable, non-copyable. */
+class MappedFile : NonCopyable
+{
+public:
+	/// Map file into memory
+	/** Throws an exception if the file could not be opened or mapped. */
+	explicit MappedFile(const char* filename);
+
+	/// Map file into memory
+	/** Throws an exception if the file could not be opened or mapped. */
+	explicit MappedFile(const std::string& filename);
+
+	MappedFile(MappedFile&& that) noexcept;
+	~MappedFile();
+
+	MappedFile& operator=(MappedFile&& that) noexcept;
+
+	const uint8_t* GetBytes() const {return static_cast<const uint8_t*>(mData);}
+	const void* GetData() const {return mData;}
+	size_t GetSize() const {return mSize;}
+
+	/// File contents as text
+	std::string_view GetText() const {return std::string_view(static_cast<const char*>(mData), mSize);}
+
+private:
+	void Unmap();
+
+	const void* mData = nullptr;
+	size_t mSize = 0;
+#ifdef _WIN32
+	void* mFile = nullptr;
+	void* mMapping = nullptr;
+#endif
+};
+
+}
+} // namespace molecular
+
+#endif // MOLECULAR_UTIL_MAPPEDFILE_H
@@ -0,0 +1,95 @@
+/*	Mesh.cpp
+
+MIT License
+
+Copyright (c) 2026 Fabian Herb
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "Mesh.h"
+
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace molecular
+{
+namespace util
+{
+
+MeshArena::MeshArena(MeshSet& meshes, size_t alignment)
+{
+	if(alignment == 0 || (alignment & (alignment - 1)) != 0)
+		throw std::range_error("MeshArena: Alignment is not a power of two");
+
+	auto Align = [alignment](size_t offset){return (offset + alignment - 1) & ~(alignment - 1);};
+
+	size_t size = 0;
+	for(auto& mesh: meshes)
+	{
+		size = Align(size) + mesh.GetIndices().size() * sizeof(uint32_t);
+		for(auto& attribute: mesh.GetAttributes())
+			size = Align(size) + attribute.second.GetRawSize();
+	}
+	if(size > std::numeric_limits<int32_t>::max())
+		throw std::range_error("MeshArena: Data exceeds 32 bit offsets");
+
+	mData = Blob(size);
+	uint8_t* bytes = mData.GetBytes();
+	mIndexBufferInfos.resize(meshes.size());
+	mVertexAttributeInfos.resize(meshes.size());
+	size_t offset = 0;
+	for(size_t i = 0; i < meshes.size(); ++i)
+	{
+		Mesh& mesh = meshes[i];
+		const std::vector<uint32_t>& indices = mesh.GetIndices();
+		offset = Align(offset);
+		if(!indices.empty())
+			std::memcpy(bytes + offset, indices.data(), indices.size() * sizeof(uint32_t));
+
+		IndexBufferInfo& indexInfo = mIndexBufferInfos[i];
+		indexInfo.mode = mesh.GetMode();
+		indexInfo.type = IndexBufferInfo::Type::kUInt32;
+		indexInfo.offset = uint32_t(offset);
+		indexInfo.count = uint32_t(indices.size());
+		indexInfo.vertexDataSet = uint32_t(i);
+		std::strncpy(indexInfo.material, mesh.GetMaterial().c_str(), sizeof(indexInfo.material) - 1);
+		offset += indices.size() * sizeof(uint32_t);
+
+		for(auto& attribute: mesh.GetAttributes())
+		{
+			Mesh::Attribute& attr = attribute.second;
+			const size_t attributeSize = attr.GetRawSize();
+			offset = Align(offset);
+			if(attributeSize)
+				std::memcpy(bytes + offset, attr.GetRawData(), attributeSize);
+			attr.SetDataReference(bytes + offset, attributeSize);
+
+			VertexAttributeInfo info(attr.GetType(), attr.GetNumComponents(), int(offset), 0, 0, attr.IsNormalized());
+			info.semantic = attribute.first;
+			mVertexAttributeInfos[i].push_back(info);
+			offset += attributeSize;
+		}
+	}
+	assert(offset == size);
+}
+
+}
+}
@@ -28,12 +28,15 @@ SOFTWARE.
 
 #include "BufferInfo.h"
 
+#include <molecular/util/Blob.h>
+#include <molecular/util/FlatMap.h>
 #include <molecular/util/Hash.h>
+#include <molecular/util/NonCopyable.h>
+#include <molecular/util/StridedView.h>
 #include <molecular/util/Vector3.h>
 #include <molecular/util/Vector4.h>
 
 #include <cassert>
-#include <unordered_map>
 #include <vector>
 
 namespace molecular
@@ -100,7 +103,7 @@ public:
 		{
 			assert(mNumComponents == AttributeTraits<T>::components);
 			assert(mType == AttributeTraits<T>::type);
-			return static_cast<const T*>(static_cast<const void*>(mData.data()));
+			return static_cast<const T*>(static_cast<const void*>(mData));
 		}
 
 		/// Get attribute data
@@ -109,32 +112,95 @@ public:
 		{
 			assert(mNumComponents == AttributeTraits<T>::components);
 			assert(mType == AttributeTraits<T>::type);
-			return static_cast<T*>(static_cast<void*>(mData.data()));
+			return static_cast<T*>(static_cast<void*>(mData));
+		}
+
+		/// Get attribute data as view
+		template<typename T>
+		StridedView<const T> GetView() const
+		{
+			return StridedView<const T>(GetData<T>(), mSize / sizeof(T));
+		}
+
+		/// Get attribute data as view
+		template<typename T>
+		StridedView<T> GetView()
+		{
+			return StridedView<T>(GetData<T>(), mSize / sizeof(T));
 		}
 
 		/// Set attribute data from raw data
 		void SetData(VertexAttributeInfo::Type type, unsigned int components, const void* data, size_t size)
+		{
+			auto begin = static_cast<const uint8_t*>(data);
+			SetData(type, components, std::vector<uint8_t>(begin, begin + size));
+		}
+
+		/// Set attribute data by taking ownership of a buffer
+		void SetData(VertexAttributeInfo::Type type, unsigned int components, std::vector<uint8_t>&& data)
 		{
 			mType = type;
 			mNumComponents = components;
-			auto begin = static_cast<const uint8_t*>(data);
-			mData.assign(begin, begin + size);
+			mNormalized = false;
+			mVector = std::move(data);
+			mBlob = Blob();
+			mData = mVector.data();
+			mSize = mVector.size();
+		}
+
+		/// Set attribute data by taking ownership of a buffer
+		void SetData(VertexAttributeInfo::Type type, unsigned int components, Blob&& data)
+		{
+			mType = type;
+			mNumComponents = components;
+			mNormalized = false;
+			mBlob = std::move(data);
+			mVector = std::vector<uint8_t>();
+			mData = mBlob.GetBytes();
+			mSize = mBlob.GetSize();
 		}
 
 		/// Get pointer to raw data
 		/** Use GetData() to get a typed representation. */
-		const void* GetRawData() const {return mData.data();}
+		const void* GetRawData() const {return mData;}
 
 		/// Get data size in bytes
-		size_t GetRawSize() const {return mData.size();}
+		size_t GetRawSize() const {return mSize;}
+
+		/// Check if the data is owned by a MeshArena
+		bool IsInArena() const {return mData && mVector.empty() && !mBlob.GetData();}
 
 		VertexAttributeInfo::Type GetType() const {return mType;}
 		unsigned int GetNumComponents() const {return mNumComponents;}
 
+		/// Check if integer data represents values in [0, 1] or [-1, 1]
+		/** Reset by SetData(). */
+		bool IsNormalized() const {return mNormalized;}
+		void SetNormalized(bool normalized) {mNormalized = normalized;}
+
 	private:
+		friend class MeshArena;
+
+		/// Reference data owned by someone else
+		void SetDataReference(uint8_t* data, size_t size)
+		{
+			mVector = std::vector<uint8_t>();
+			mBlob = Blob();
+			mData = data;
+			mSize = size;
+		}
+
 		VertexAttributeInfo::Type mType;
 		unsigned int mNumComponents;
-		std::vector<uint8_t> mData;
+		bool mNormalized = false;
+
+		/// Storage if the data is owned, at most one of them is used
+		std::vector<uint8_t> mVector;
+		Blob mBlob;
+
+		/// Current data, pointing into mVector, mBlob or a MeshArena
+		uint8_t* mData = nullptr;
+		size_t mSize = 0;
 	};
 
 	/// Construct from number of vertices
@@ -150,22 +216,29 @@ public:
 	void SetAttributeData(Hash name, const T* data, size_t count)
 	{
 		assert(count == mNumVertices);
-		Attribute attr;
-		attr.mType = AttributeTraits<T>::type;
-		attr.mNumComponents = AttributeTraits<T>::components;
-		auto begin = static_cast<const uint8_t*>(static_cast<const void*>(data));
-		attr.mData.assign(begin, begin + count * sizeof(T));
-		mAttributes.emplace(name, std::move(attr));
+		SetAttributeData(name, AttributeTraits<T>::type, AttributeTraits<T>::components, data, count * sizeof(T));
 	}
 
 	/// Set attribute data from raw data
 	void SetAttributeData(Hash name, VertexAttributeInfo::Type type, unsigned int components, const void* data, size_t size)
 	{
-		Attribute attr;
-		attr.mType = type;
-		attr.mNumComponents = components;
 		auto begin = static_cast<const uint8_t*>(data);
-		attr.mData.assign(begin, begin + size);
+		SetAttributeData(name, type, components, std::vector<uint8_t>(begin, begin + size));
+	}
+
+	/// Set attribute data by taking ownership of a buffer
+	void SetAttributeData(Hash name, VertexAttributeInfo::Type type, unsigned int components, std::vector<uint8_t>&& data)
+	{
+		Attribute attr;
+		attr.SetData(type, components, std::move(data));
+		mAttributes.emplace(name, std::move(attr));
+	}
+
+	/// Set attribute data by taking ownership of a buffer
+	void SetAttributeData(Hash name, VertexAttributeInfo::Type type, unsigned int components, Blob&& data)
+	{
+		Attribute attr;
+		attr.SetData(type, components, std::move(data));
 		mAttributes.emplace(name, std::move(attr));
 	}
 
@@ -180,8 +253,10 @@ public:
 
 	unsigned int GetNumVertices() const {return mNumVertices;}
 
-	const std::unordered_map<Hash, Attribute>& GetAttributes() const {return mAttributes;}
-	std::unordered_map<Hash, Attribute>& GetAttributes() {return mAttributes;}
+	/// Attributes in ascending order of their names
+	/** Adding or removing attributes invalidates references to other attributes. */
+	const FlatMap<Hash, Attribute>& GetAttributes() const {return mAttributes;}
+	FlatMap<Hash, Attribute>& GetAttributes() {return mAttributes;}
 	const Attribute& GetAttribute(Hash name) const {return mAttributes.at(name);}
 	Attribute& GetAttribute(Hash name) {return mAttributes.at(name);}
 	void RemoveAttribute(Hash name) {mAttributes.erase(name);}
@@ -191,12 +266,46 @@ private:
 	unsigned int mNumVertices;
 	IndexBufferInfo::Mode mMode;
 	std::string mMaterial;
-	std::unordered_map<Hash, Attribute> mAttributes;
+	FlatMap<Hash, Attribute> mAttributes;
 };
 
 /// Collection of meshes
 using MeshSet = std::vector<Mesh>;
 
+/// Single allocation holding the vertex attributes and indices of a MeshSet
+/** All attribute data is moved into the arena and the attributes of the meshes
+	reference it afterwards, so the arena must outlive their use. Setting new data
+	on an attribute makes it own its data again. Indices are copied, because Mesh
+	keeps them in a std::vector for processing. The whole arena can be written to a
+	file or uploaded to a GPU buffer at once. Movable, non-copyable. */
+class MeshArena : MovableOnly
+{
+public:
+	MeshArena() = default;
+
+	/// Pack all attributes and indices of the meshes into one allocation
+	/** @param alignment Alignment of each attribute and index range in bytes.
+		@throw std::range_error if alignment is not a power of two or the arena
+			would exceed the 32 bit offsets of IndexBufferInfo. */
+	explicit MeshArena(MeshSet& meshes, size_t alignment = 16);
+
+	const void* GetData() const {return mData.GetData();}
+	size_t GetSize() const {return mData.GetSize();}
+
+	/// Location of the indices of each mesh in the arena
+	/** vertexDataSet is the index of the mesh in the MeshSet. */
+	const std::vector<IndexBufferInfo>& GetIndexBufferInfos() const {return mIndexBufferInfos;}
+
+	/// Location of the attributes of each mesh in the arena
+	/** Attributes are tightly packed, the semantic member contains the name. */
+	const std::vector<std::vector<VertexAttributeInfo>>& GetVertexAttributeInfos() const {return mVertexAttributeInfos;}
+
+private:
+	Blob mData;
+	std::vector<IndexBufferInfo> mIndexBufferInfos;
+	std::vector<std::vector<VertexAttributeInfo>> mVertexAttributeInfos;
+};
+
 }
 }
 
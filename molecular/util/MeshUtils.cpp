@@ -27,30 +27,1638 @@ SOFTWARE.
 
 #include <molecular/util/FloatToHalf.h>
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <cstring>
+#include <limits>
+#include <stdexcept>
 #include <unordered_map>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MOLECULAR_MESHUTILS_SSE2 1
+#include <emmintrin.h>
+#else
+#define MOLECULAR_MESHUTILS_SSE2 0
+#endif
+
 namespace molecular
 {
-namespace util
+namespace util
+{
+
+namespace MeshUtils
+{
+
+namespace
+{
+
+/// Elements processed by one task in UnifyIndicesBySorting()
+const size_t kSortBlockSize = 1 << 16;
+
+/// Combined key and original position of an index
+struct SortRecord
+{
+	uint64_t key;
+	uint32_t position;
+};
+
+/// Number of bits needed to represent values less than count
+unsigned int BitsFor(size_t count)
+{
+	unsigned int bits = 0;
+	while(bits < 64 && (uint64_t(1) << bits) < count)
+		bits++;
+	return bits;
+}
+
+size_t NumBlocks(size_t count)
+{
+	return (count + kSortBlockSize - 1) / kSortBlockSize;
+}
+
+/// Stable parallel LSD radix sort by the lower keyBits bits of the keys
+/** @param temp Scratch buffer, resized as needed. */
+void RadixSort(TaskDispatcher& dispatcher, std::vector<SortRecord>& records, std::vector<SortRecord>& temp, unsigned int keyBits)
+{
+	const unsigned int kDigitBits = 11;
+	const size_t kNumDigits = 1 << kDigitBits;
+	const size_t count = records.size();
+	const size_t numBlocks = NumBlocks(count);
+	temp.resize(count);
+	std::vector<size_t> offsets(numBlocks * kNumDigits);
+	for(unsigned int shift = 0; shift < keyBits; shift += kDigitBits)
+	{
+		std::fill(offsets.begin(), offsets.end(), 0);
+		ParallelFor(dispatcher, numBlocks, [&](size_t block)
+		{
+			size_t* histogram = &offsets[block * kNumDigits];
+			const size_t end = std::min(count, (block + 1) * kSortBlockSize);
+			for(size_t i = block * kSortBlockSize; i < end; ++i)
+				histogram[(records[i].key >> shift) & (kNumDigits - 1)]++;
+		});
+
+		// Digit-major order keeps the sort stable across blocks:
+		size_t sum = 0;
+		bool sorted = false;
+		for(size_t digit = 0; digit < kNumDigits; ++digit)
+		{
+			for(size_t block = 0; block < numBlocks; ++block)
+			{
+				const size_t blockCount = offsets[block * kNumDigits + digit];
+				offsets[block * kNumDigits + digit] = sum;
+				sum += blockCount;
+			}
+			if(sum == count && offsets[digit] == 0)
+				sorted = true; // All keys have the same digit
+		}
+		if(sorted)
+			continue;
+
+		ParallelFor(dispatcher, numBlocks, [&](size_t block)
+		{
+			size_t* blockOffsets = &offsets[block * kNumDigits];
+			const size_t end = std::min(count, (block + 1) * kSortBlockSize);
+			for(size_t i = block * kSortBlockSize; i < end; ++i)
+				temp[blockOffsets[(records[i].key >> shift) & (kNumDigits - 1)]++] = records[i];
+		});
+		records.swap(temp);
+	}
+}
+
+}
+
+void UnifyIndicesBySorting(
+		TaskDispatcher& dispatcher,
+		size_t numIndices,
+		size_t numStreams,
+		const uint32_t* const indices[],
+		const size_t numAttributes[],
+		uint32_t indexBase,
+		std::vector<uint32_t>& outIndices,
+		std::vector<uint32_t>& outFirstOccurrences)
+{
+	assert(numStreams > 0);
+	if(numIndices > std::numeric_limits<uint32_t>::max())
+		throw std::range_error("UnifyIndicesBySorting: Too many indices");
+
+	outFirstOccurrences.clear();
+	const size_t outOffset = outIndices.size();
+	outIndices.resize(outOffset + numIndices);
+	if(numIndices == 0)
+		return;
+
+	unsigned int keyBits = 0;
+	for(size_t stream = 0; stream < numStreams; ++stream)
+		keyBits += BitsFor(numAttributes[stream]);
+
+	std::vector<uint32_t> prefixIds;
+	const uint32_t* const* streams = indices;
+	const size_t* streamSizes = numAttributes;
+	const uint32_t* reducedIndices[2];
+	size_t reducedSizes[2];
+	if(keyBits > 64)
+	{
+		// Key does not fit: Unify all but the last stream first and combine the result with the last stream.
+		std::vector<uint32_t> firstOccurrences;
+		UnifyIndicesBySorting(dispatcher, numIndices, numStreams - 1, indices, numAttributes, 0, prefixIds, firstOccurrences);
+		reducedIndices[0] = prefixIds.data();
+		reducedIndices[1] = indices[numStreams - 1];
+		reducedSizes[0] = firstOccurrences.size();
+		reducedSizes[1] = numAttributes[numStreams - 1];
+		streams = reducedIndices;
+		streamSizes = reducedSizes;
+		numStreams = 2;
+		keyBits = BitsFor(reducedSizes[0]) + BitsFor(reducedSizes[1]);
+	}
+
+	std::vector<unsigned int> streamBits(numStreams);
+	for(size_t stream = 0; stream < numStreams; ++stream)
+		streamBits[stream] = BitsFor(streamSizes[stream]);
+
+	const size_t numBlocks = NumBlocks(numIndices);
+	std::vector<SortRecord> records(numIndices);
+	ParallelFor(dispatcher, numBlocks, [&](size_t block)
+	{
+		const size_t end = std::min(numIndices, (block + 1) * kSortBlockSize);
+		for(size_t i = block * kSortBlockSize; i < end; ++i)
+		{
+			uint64_t key = 0;
+			for(size_t stream = 0; stream < numStreams; ++stream)
+			{
+				assert(streams[stream][i] < streamSizes[stream]);
+				const unsigned int bits = streamBits[stream];
+				key = (bits < 64 ? key << bits : 0) | streams[stream][i];
+			}
+			records[i] = SortRecord{key, uint32_t(i)};
+		}
+	});
+
+	{
+		std::vector<SortRecord> temp;
+		RadixSort(dispatcher, records, temp, keyBits);
+	}
+
+	// The sort is stable, so the first record of each run of equal keys is the first occurrence.
+	// Also note the sorted index of the last run start in each block:
+	std::vector<uint8_t> isFirst(numIndices, 0);
+	std::vector<size_t> lastRunStarts(numBlocks, numIndices);
+	ParallelFor(dispatcher, numBlocks, [&](size_t block)
+	{
+		const size_t end = std::min(numIndices, (block + 1) * kSortBlockSize);
+		for(size_t i = block * kSortBlockSize; i < end; ++i)
+		{
+			if(i == 0 || records[i].key != records[i - 1].key)
+			{
+				isFirst[records[i].position] = 1;
+				lastRunStarts[block] = i;
+			}
+		}
+	});
+
+	// Number first occurrences in order of their position with an exclusive scan:
+	std::vector<uint32_t> blockSums(numBlocks + 1, 0);
+	ParallelFor(dispatcher, numBlocks, [&](size_t block)
+	{
+		const size_t end = std::min(numIndices, (block + 1) * kSortBlockSize);
+		uint32_t sum = 0;
+		for(size_t i = block * kSortBlockSize; i < end; ++i)
+			sum += isFirst[i];
+		blockSums[block + 1] = sum;
+	});
+	for(size_t block = 0; block < numBlocks; ++block)
+		blockSums[block + 1] += blockSums[block];
+
+	std::vector<uint32_t> ids(numIndices);
+	outFirstOccurrences.resize(blockSums[numBlocks]);
+	ParallelFor(dispatcher, numBlocks, [&](size_t block)
+	{
+		const size_t end = std::min(numIndices, (block + 1) * kSortBlockSize);
+		uint32_t id = blockSums[block];
+		for(size_t i = block * kSortBlockSize; i < end; ++i)
+		{
+			if(isFirst[i])
+			{
+				ids[i] = id;
+				outFirstOccurrences[id] = uint32_t(i);
+				id++;
+			}
+		}
+	});
+
+	// Sorted index where the run containing the first record of each block begins. Runs can span many blocks:
+	std::vector<size_t> blockRunHeads(numBlocks, 0);
+	for(size_t block = 1; block < numBlocks; ++block)
+	{
+		const size_t begin = block * kSortBlockSize;
+		if(records[begin].key != records[begin - 1].key)
+			blockRunHeads[block] = begin;
+		else if(lastRunStarts[block - 1] != numIndices)
+			blockRunHeads[block] = lastRunStarts[block - 1];
+		else
+			blockRunHeads[block] = blockRunHeads[block - 1];
+	}
+
+	// Scatter the ID of each run to all its positions:
+	uint32_t* out = outIndices.data() + outOffset;
+	ParallelFor(dispatcher, numBlocks, [&](size_t block)
+	{
+		const size_t begin = block * kSortBlockSize;
+		const size_t end = std::min(numIndices, begin + kSortBlockSize);
+		uint32_t id = ids[records[blockRunHeads[block]].position];
+		for(size_t i = begin; i < end; ++i)
+		{
+			if(i != begin && records[i].key != records[i - 1].key)
+				id = ids[records[i].position];
+			out[records[i].position] = indexBase + id;
+		}
+	});
+}
+
+namespace
+{
+
+/// Triangles adjacent to each vertex in compressed row storage
+struct VertexTriangleAdjacency
+{
+	VertexTriangleAdjacency(const uint32_t indices[], size_t numIndices, size_t numVertices) :
+		offsets(numVertices + 1, 0),
+		triangles(numIndices)
+	{
+		for(size_t i = 0; i < numIndices; ++i)
+		{
+			assert(indices[i] < numVertices);
+			offsets[indices[i] + 1]++;
+		}
+		for(size_t v = 0; v < numVertices; ++v)
+			offsets[v + 1] += offsets[v];
+
+		std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+		for(size_t i = 0; i < numIndices; ++i)
+			triangles[fill[indices[i]]++] = uint32_t(i / 3);
+	}
+
+	const uint32_t* begin(uint32_t vertex) const {return triangles.data() + offsets[vertex];}
+	const uint32_t* end(uint32_t vertex) const {return triangles.data() + offsets[vertex + 1];}
+
+	std::vector<uint32_t> offsets;
+	std::vector<uint32_t> triangles;
+};
+
+/// Get positions of a mesh consisting of triangles, or throw
+/** Positions must be three floats per vertex, so meshes processed by ReducePrecision() are rejected. */
+const Vector3* TrianglePositions(const Mesh& mesh, const char* function)
+{
+	if(mesh.GetMode() != IndexBufferInfo::Mode::kTriangles)
+		throw std::runtime_error(std::string(function) + ": Mesh does not consist of triangles");
+	auto positions = mesh.GetAttributes().find(VertexAttributeInfo::kPosition);
+	if(positions == mesh.GetAttributes().end())
+		throw std::runtime_error(std::string(function) + ": Mesh has no positions");
+	const Mesh::Attribute& attribute = positions->second;
+	if(attribute.GetType() != VertexAttributeInfo::kFloat
+			|| attribute.GetNumComponents() != 3
+			|| attribute.GetRawSize() != size_t(mesh.GetNumVertices()) * sizeof(Vector3))
+		throw std::runtime_error(std::string(function) + ": Positions are not three floats per vertex");
+	return attribute.GetData<Vector3>();
+}
+
+}
+
+float CalculateAcmr(const uint32_t indices[], size_t numIndices, unsigned int cacheSize)
+{
+	if(numIndices < 3)
+		return 0;
+
+	const uint32_t numVertices = *std::max_element(indices, indices + numIndices) + 1;
+	std::vector<size_t> timeStamps(numVertices, 0);
+	size_t time = cacheSize + 1;
+	size_t misses = 0;
+	for(size_t i = 0; i < numIndices; ++i)
+	{
+		if(time - timeStamps[indices[i]] > cacheSize)
+		{
+			timeStamps[indices[i]] = time++;
+			misses++;
+		}
+	}
+	return float(misses) / float(numIndices / 3);
+}
+
+namespace
+{
+
+/// Tipsify triangle reordering
+/** @param hardBoundaries If not nullptr, receives the first triangle after each
+		dead end, where the vertex cache contents are unrelated to the next triangles. */
+void Tipsify(const uint32_t indices[], size_t numIndices, size_t numVertices, uint32_t outIndices[], unsigned int cacheSize, std::vector<uint32_t>* hardBoundaries)
+{
+	assert(indices != outIndices);
+	const size_t numTriangles = numIndices / 3;
+	VertexTriangleAdjacency adjacency(indices, numTriangles * 3, numVertices);
+	std::vector<uint32_t> liveTriangles(numVertices);
+	for(size_t v = 0; v < numVertices; ++v)
+		liveTriangles[v] = adjacency.offsets[v + 1] - adjacency.offsets[v];
+
+	std::vector<size_t> cacheTimeStamps(numVertices, 0);
+	std::vector<bool> emitted(numTriangles, false);
+	std::vector<uint32_t> deadEndStack;
+	std::vector<uint32_t> candidates;
+	size_t time = cacheSize + 1;
+	size_t cursor = 0;
+	size_t outIndex = 0;
+
+	const int64_t kNone = -1;
+	int64_t fanningVertex = numVertices > 0 ? 0 : kNone;
+	while(fanningVertex != kNone)
+	{
+		// Emit all remaining triangles around the fanning vertex:
+		candidates.clear();
+		const uint32_t vertex = uint32_t(fanningVertex);
+		for(auto it = adjacency.begin(vertex); it != adjacency.end(vertex); ++it)
+		{
+			const uint32_t triangle = *it;
+			if(emitted[triangle])
+				continue;
+
+			for(size_t corner = 0; corner < 3; ++corner)
+			{
+				const uint32_t v = indices[triangle * 3 + corner];
+				outIndices[outIndex++] = v;
+				deadEndStack.push_back(v);
+				candidates.push_back(v);
+				liveTriangles[v]--;
+				if(time - cacheTimeStamps[v] > cacheSize)
+					cacheTimeStamps[v] = time++;
+			}
+			emitted[triangle] = true;
+		}
+
+		// Prefer the candidate still in cache with the most remaining triangles:
+		fanningVertex = kNone;
+		size_t bestPriority = 0;
+		for(uint32_t v: candidates)
+		{
+			if(liveTriangles[v] == 0)
+				continue;
+
+			size_t priority = 0;
+			const size_t age = time - cacheTimeStamps[v];
+			if(age + 2 * liveTriangles[v] <= cacheSize)
+				priority = age;
+			if(fanningVertex == kNone || priority > bestPriority)
+			{
+				fanningVertex = v;
+				bestPriority = priority;
+			}
+		}
+
+		// Dead end, continue with a recently used vertex or the next unprocessed one:
+		if(fanningVertex == kNone && hardBoundaries && outIndex / 3 < numTriangles)
+			hardBoundaries->push_back(uint32_t(outIndex / 3));
+		while(fanningVertex == kNone && !deadEndStack.empty())
+		{
+			const uint32_t v = deadEndStack.back();
+			deadEndStack.pop_back();
+			if(liveTriangles[v] > 0)
+				fanningVertex = v;
+		}
+		while(fanningVertex == kNone && cursor < numVertices)
+		{
+			if(liveTriangles[cursor] > 0)
+				fanningVertex = int64_t(cursor);
+			cursor++;
+		}
+	}
+	assert(outIndex == numTriangles * 3);
+
+	// Incomplete trailing triangle:
+	std::copy(indices + outIndex, indices + numIndices, outIndices + outIndex);
+}
+
+}
+
+void OptimizeVertexCache(const uint32_t indices[], size_t numIndices, size_t numVertices, uint32_t outIndices[], unsigned int cacheSize)
+{
+	Tipsify(indices, numIndices, numVertices, outIndices, cacheSize, nullptr);
+}
+
+VertexCacheStatistics OptimizeVertexCache(Mesh& mesh, unsigned int cacheSize)
+{
+	if(mesh.GetMode() != IndexBufferInfo::Mode::kTriangles)
+		throw std::runtime_error("OptimizeVertexCache: Mesh does not consist of triangles");
+
+	std::vector<uint32_t>& indices = mesh.GetIndices();
+	VertexCacheStatistics statistics;
+	statistics.acmrBefore = CalculateAcmr(indices.data(), indices.size(), cacheSize);
+	std::vector<uint32_t> optimized(indices.size());
+	OptimizeVertexCache(indices.data(), indices.size(), mesh.GetNumVertices(), optimized.data(), cacheSize);
+	indices.swap(optimized);
+	statistics.acmrAfter = CalculateAcmr(indices.data(), indices.size(), cacheSize);
+	return statistics;
+}
+
+namespace
+{
+
+/// Split runs of triangles between hard boundaries where the local ACMR gets low enough
+std::vector<uint32_t> OverdrawClusters(const uint32_t indices[], size_t numTriangles, size_t numVertices, const std::vector<uint32_t>& hardBoundaries, float threshold, unsigned int cacheSize)
+{
+	std::vector<size_t> timeStamps(numVertices, 0);
+	size_t time = cacheSize + 1;
+	auto triangleMisses = [&](size_t triangle)
+	{
+		unsigned int misses = 0;
+		for(size_t corner = 0; corner < 3; ++corner)
+		{
+			const uint32_t v = indices[triangle * 3 + corner];
+			if(time - timeStamps[v] > cacheSize)
+			{
+				timeStamps[v] = time++;
+				misses++;
+			}
+		}
+		return misses;
+	};
+	auto flushCache = [&](){time += cacheSize + 1;};
+
+	std::vector<uint32_t> clusters;
+	for(size_t run = 0; run <= hardBoundaries.size(); ++run)
+	{
+		const size_t begin = run == 0 ? 0 : hardBoundaries[run - 1];
+		const size_t end = run == hardBoundaries.size() ? numTriangles : hardBoundaries[run];
+		if(begin >= end)
+			continue;
+
+		flushCache();
+		size_t runMisses = 0;
+		for(size_t triangle = begin; triangle < end; ++triangle)
+			runMisses += triangleMisses(triangle);
+		const float runThreshold = threshold * float(runMisses) / float(end - begin);
+
+		flushCache();
+		clusters.push_back(uint32_t(begin));
+		size_t clusterBegin = begin;
+		size_t clusterMisses = 0;
+		for(size_t triangle = begin; triangle < end; ++triangle)
+		{
+			clusterMisses += triangleMisses(triangle);
+			if(triangle + 1 < end && float(clusterMisses) / float(triangle + 1 - clusterBegin) <= runThreshold)
+			{
+				clusterBegin = triangle + 1;
+				clusterMisses = 0;
+				clusters.push_back(uint32_t(clusterBegin));
+				flushCache();
+			}
+		}
+	}
+	return clusters;
+}
+
+}
+
+void OptimizeOverdraw(const uint32_t indices[], size_t numIndices, const Vector3 positions[], size_t numVertices, uint32_t outIndices[], float threshold, unsigned int cacheSize)
+{
+	assert(indices != outIndices);
+	const size_t numTriangles = numIndices / 3;
+	std::vector<uint32_t> ordered(numIndices);
+	std::vector<uint32_t> hardBoundaries;
+	Tipsify(indices, numIndices, numVertices, ordered.data(), cacheSize, &hardBoundaries);
+	std::vector<uint32_t> clusters = OverdrawClusters(ordered.data(), numTriangles, numVertices, hardBoundaries, threshold, cacheSize);
+	clusters.push_back(uint32_t(numTriangles));
+
+	// Area weighted centroids and normals of clusters and the whole mesh:
+	const size_t numClusters = clusters.size() - 1;
+	std::vector<Vector3> centroids(numClusters, Vector3(0, 0, 0));
+	std::vector<Vector3> normals(numClusters, Vector3(0, 0, 0));
+	Vector3 meshCentroid(0, 0, 0);
+	float meshArea = 0;
+	for(size_t cluster = 0; cluster < numClusters; ++cluster)
+	{
+		float area = 0;
+		for(size_t triangle = clusters[cluster]; triangle < clusters[cluster + 1]; ++triangle)
+		{
+			const Vector3& p0 = positions[ordered[triangle * 3]];
+			const Vector3& p1 = positions[ordered[triangle * 3 + 1]];
+			const Vector3& p2 = positions[ordered[triangle * 3 + 2]];
+			const Vector3 normal = (p1 - p0).CrossProduct(p2 - p0);
+			const float triangleArea = normal.Length();
+			centroids[cluster] += (p0 + p1 + p2) * (triangleArea / 3.0f);
+			normals[cluster] += normal;
+			area += triangleArea;
+		}
+		meshCentroid += centroids[cluster];
+		meshArea += area;
+		if(area > 0)
+			centroids[cluster] /= area;
+	}
+	if(meshArea > 0)
+		meshCentroid /= meshArea;
+
+	std::vector<float> sortKeys(numClusters);
+	for(size_t cluster = 0; cluster < numClusters; ++cluster)
+	{
+		const float length = normals[cluster].Length();
+		sortKeys[cluster] = length > 0 ? (centroids[cluster] - meshCentroid).DotProduct(normals[cluster]) / length : 0;
+	}
+
+	std::vector<uint32_t> order(numClusters);
+	for(size_t cluster = 0; cluster < numClusters; ++cluster)
+		order[cluster] = uint32_t(cluster);
+	std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b){return sortKeys[a] > sortKeys[b];});
+
+	uint32_t* out = outIndices;
+	for(uint32_t cluster: order)
+		out = std::copy(ordered.begin() + clusters[cluster] * 3, ordered.begin() + clusters[cluster + 1] * 3, out);
+	std::copy(ordered.begin() + numTriangles * 3, ordered.end(), out);
+}
+
+VertexCacheStatistics OptimizeOverdraw(Mesh& mesh, float threshold, unsigned int cacheSize)
+{
+	const Vector3* positions = TrianglePositions(mesh, "OptimizeOverdraw");
+
+	std::vector<uint32_t>& indices = mesh.GetIndices();
+	VertexCacheStatistics statistics;
+	statistics.acmrBefore = CalculateAcmr(indices.data(), indices.size(), cacheSize);
+	std::vector<uint32_t> optimized(indices.size());
+	OptimizeOverdraw(indices.data(), indices.size(), positions, mesh.GetNumVertices(), optimized.data(), threshold, cacheSize);
+	indices.swap(optimized);
+	statistics.acmrAfter = CalculateAcmr(indices.data(), indices.size(), cacheSize);
+	return statistics;
+}
+
+namespace
+{
+
+/// Symmetric 4x4 matrix summing up squared distances to planes
+struct Quadric
+{
+	double a00, a01, a02, a03, a11, a12, a13, a22, a23, a33;
+
+	void AddPlane(double a, double b, double c, double d)
+	{
+		a00 += a * a; a01 += a * b; a02 += a * c; a03 += a * d;
+		a11 += b * b; a12 += b * c; a13 += b * d;
+		a22 += c * c; a23 += c * d;
+		a33 += d * d;
+	}
+
+	Quadric& operator+=(const Quadric& q)
+	{
+		a00 += q.a00; a01 += q.a01; a02 += q.a02; a03 += q.a03;
+		a11 += q.a11; a12 += q.a12; a13 += q.a13;
+		a22 += q.a22; a23 += q.a23;
+		a33 += q.a33;
+		return *this;
+	}
+
+	/// Sum of squared distances of a point to all planes
+	double Evaluate(const Vector3& p) const
+	{
+		const double x = p[0], y = p[1], z = p[2];
+		const double result = x * x * a00 + 2 * x * y * a01 + 2 * x * z * a02 + 2 * x * a03
+				+ y * y * a11 + 2 * y * z * a12 + 2 * y * a13
+				+ z * z * a22 + 2 * z * a23
+				+ a33;
+		return std::max(result, 0.0);
+	}
+};
+
+/// Candidate for moving one vertex onto another
+struct Collapse
+{
+	float cost;
+	uint32_t from;
+	uint32_t to;
+};
+
+/// Stable LSD radix sort by cost
+/** Bit patterns of non-negative floats have the same order as their values. */
+void SortByCost(std::vector<Collapse>& collapses, std::vector<Collapse>& temp)
+{
+	auto key = [](const Collapse& collapse)
+	{
+		uint32_t bits;
+		std::memcpy(&bits, &collapse.cost, sizeof(bits));
+		return bits;
+	};
+
+	const unsigned int kDigitBits = 11;
+	const size_t kNumDigits = 1 << kDigitBits;
+	temp.resize(collapses.size());
+	std::vector<size_t> offsets(kNumDigits);
+	for(unsigned int shift = 0; shift < 32; shift += kDigitBits)
+	{
+		std::fill(offsets.begin(), offsets.end(), 0);
+		for(const Collapse& collapse: collapses)
+			offsets[(key(collapse) >> shift) & (kNumDigits - 1)]++;
+		size_t sum = 0;
+		for(auto& offset: offsets)
+		{
+			const size_t count = offset;
+			offset = sum;
+			sum += count;
+		}
+		for(const Collapse& collapse: collapses)
+			temp[offsets[(key(collapse) >> shift) & (kNumDigits - 1)]++] = collapse;
+		collapses.swap(temp);
+	}
+}
+
+/// Find vertices on attribute seams or open and non-manifold borders
+std::vector<bool> LockedVertices(const uint32_t indices[], size_t numIndices, const Vector3 positions[], size_t numVertices)
+{
+	// Group vertices with equal positions:
+	std::vector<bool> locked(numVertices, false);
+	std::vector<uint32_t> groups(numVertices);
+	FlatHashMap<IndexTriple, uint32_t, IndexTripleHash> positionGroups(numVertices);
+	for(size_t i = 0; i < numVertices; ++i)
+	{
+		IndexTriple key;
+		const float coordinates[3] = {positions[i][0] + 0.0f, positions[i][1] + 0.0f, positions[i][2] + 0.0f}; // Adding 0 turns -0 into 0
+		std::memcpy(&key, coordinates, sizeof(key));
+		auto result = positionGroups.Insert(key, uint32_t(i));
+		groups[i] = *result.first;
+		if(!result.second)
+			locked[i] = locked[*result.first] = true;
+	}
+
+	// Edges between position groups must be shared by exactly two triangles:
+	FlatHashMap<uint64_t, uint32_t> edgeCounts(numIndices / 2); // Closed meshes have 1.5 edges per triangle
+	for(size_t i = 0; i + 2 < numIndices; i += 3)
+	{
+		for(size_t corner = 0; corner < 3; ++corner)
+		{
+			const uint64_t a = groups[indices[i + corner]];
+			const uint64_t b = groups[indices[i + (corner + 1) % 3]];
+			auto result = edgeCounts.Insert(std::min(a, b) << 32 | std::max(a, b), 0);
+			(*result.first)++;
+		}
+	}
+	for(size_t i = 0; i + 2 < numIndices; i += 3)
+	{
+		for(size_t corner = 0; corner < 3; ++corner)
+		{
+			const uint32_t a = indices[i + corner];
+			const uint32_t b = indices[i + (corner + 1) % 3];
+			const uint64_t groupA = groups[a], groupB = groups[b];
+			if(*edgeCounts.Find(std::min(groupA, groupB) << 32 | std::max(groupA, groupB)) != 2)
+				locked[a] = locked[b] = true;
+		}
+	}
+	return locked;
+}
+
+/// Returns true if moving a vertex flips the normal of one of its triangles
+bool CollapseFlipsTriangle(const Collapse& collapse, const VertexTriangleAdjacency& adjacency, const std::vector<uint32_t>& indices, const Vector3 positions[])
+{
+	const Vector3& target = positions[collapse.to];
+	for(auto it = adjacency.begin(collapse.from); it != adjacency.end(collapse.from); ++it)
+	{
+		const uint32_t* corners = &indices[*it * 3];
+		if(corners[0] == collapse.to || corners[1] == collapse.to || corners[2] == collapse.to)
+			continue; // Triangle collapses
+
+		Vector3 p[3] = {positions[corners[0]], positions[corners[1]], positions[corners[2]]};
+		const Vector3 before = (p[1] - p[0]).CrossProduct(p[2] - p[0]);
+		for(size_t corner = 0; corner < 3; ++corner)
+		{
+			if(corners[corner] == collapse.from)
+				p[corner] = target;
+		}
+		const Vector3 after = (p[1] - p[0]).CrossProduct(p[2] - p[0]);
+		if(before.DotProduct(after) <= 0)
+			return true;
+	}
+	return false;
+}
+
+}
+
+std::vector<uint32_t> Simplify(const uint32_t indices[], size_t numIndices, const Vector3 positions[], size_t numVertices, size_t targetTriangleCount, float maxError, float* outError)
+{
+	std::vector<uint32_t> result(indices, indices + numIndices / 3 * 3);
+	const std::vector<bool> locked = LockedVertices(result.data(), result.size(), positions, numVertices);
+
+	std::vector<Quadric> quadrics(numVertices, Quadric());
+	for(size_t i = 0; i < result.size(); i += 3)
+	{
+		const Vector3& p0 = positions[result[i]];
+		const Vector3 normal = (positions[result[i + 1]] - p0).CrossProduct(positions[result[i + 2]] - p0);
+		const float length = normal.Length();
+		if(length == 0)
+			continue;
+		const Vector3 n = normal / length;
+		Quadric q = Quadric();
+		q.AddPlane(n[0], n[1], n[2], -n.DotProduct(p0));
+		for(size_t corner = 0; corner < 3; ++corner)
+			quadrics[result[i + corner]] += q;
+	}
+
+	const double maxCost = double(maxError) * double(maxError);
+	double error = 0;
+	std::vector<Collapse> candidates, sortTemp;
+	std::vector<uint32_t> remap(numVertices);
+	std::vector<bool> touched(numVertices);
+	while(result.size() / 3 > targetTriangleCount)
+	{
+		// Cheaper direction of each edge:
+		candidates.clear();
+		for(size_t i = 0; i < result.size(); i += 3)
+		{
+			for(size_t corner = 0; corner < 3; ++corner)
+			{
+				const uint32_t a = result[i + corner];
+				const uint32_t b = result[i + (corner + 1) % 3];
+				if(a > b || (locked[a] && locked[b]))
+					continue;
+
+				const double kLocked = std::numeric_limits<double>::infinity();
+				const double costAB = locked[a] ? kLocked : quadrics[a].Evaluate(positions[b]);
+				const double costBA = locked[b] ? kLocked : quadrics[b].Evaluate(positions[a]);
+				const Collapse collapse = costAB <= costBA ? Collapse{float(costAB), a, b} : Collapse{float(costBA), b, a};
+				if(double(collapse.cost) <= maxCost)
+					candidates.push_back(collapse);
+			}
+		}
+		if(candidates.empty())
+			break;
+		SortByCost(candidates, sortTemp);
+
+		// Each collapse removes about two triangles, only consider the cheapest ones needed. Some of
+		// them are rejected in every pass, so always allow a fraction of all candidates, and go on
+		// until at least one succeeds:
+		const size_t numTriangles = result.size() / 3;
+		const size_t neededCollapses = (numTriangles - targetTriangleCount + 1) / 2;
+		const float costLimit = candidates[std::min(std::max(neededCollapses, candidates.size() / 16), candidates.size() - 1)].cost;
+
+		VertexTriangleAdjacency adjacency(result.data(), result.size(), numVertices);
+		for(size_t v = 0; v < numVertices; ++v)
+			remap[v] = uint32_t(v);
+		std::fill(touched.begin(), touched.end(), false);
+		size_t removed = 0;
+		for(const Collapse& collapse: candidates)
+		{
+			if((collapse.cost > costLimit && removed > 0) || numTriangles - removed <= targetTriangleCount)
+				break;
+			if(touched[collapse.from] || touched[collapse.to] || CollapseFlipsTriangle(collapse, adjacency, result, positions))
+				continue;
+
+			// Neighbourhood is stale until the indices are rewritten:
+			for(auto it = adjacency.begin(collapse.from); it != adjacency.end(collapse.from); ++it)
+			{
+				const uint32_t* corners = &result[*it * 3];
+				touched[corners[0]] = touched[corners[1]] = touched[corners[2]] = true;
+				if(corners[0] == collapse.to || corners[1] == collapse.to || corners[2] == collapse.to)
+					removed++;
+			}
+			remap[collapse.from] = collapse.to;
+			quadrics[collapse.to] += quadrics[collapse.from];
+			error = std::max(error, double(collapse.cost));
+		}
+		if(removed == 0)
+			break;
+
+		size_t out = 0;
+		for(size_t i = 0; i < result.size(); i += 3)
+		{
+			const uint32_t a = remap[result[i]], b = remap[result[i + 1]], c = remap[result[i + 2]];
+			if(a != b && b != c && a != c)
+			{
+				result[out++] = a;
+				result[out++] = b;
+				result[out++] = c;
+			}
+		}
+		result.resize(out);
+	}
+
+	if(outError)
+		*outError = float(std::sqrt(error));
+	return result;
+}
+
+std::vector<uint32_t> Simplify(const Mesh& mesh, size_t targetTriangleCount, float maxError, float* outError)
+{
+	const Vector3* positions = TrianglePositions(mesh, "Simplify");
+	const auto& indices = mesh.GetIndices();
+	return Simplify(indices.data(), indices.size(), positions, mesh.GetNumVertices(), targetTriangleCount, maxError, outError);
+}
+
+std::vector<std::vector<uint32_t>> SimplifyLodChain(const Mesh& mesh, size_t numLevels, float reduction, float maxError)
+{
+	const Vector3* positions = TrianglePositions(mesh, "SimplifyLodChain");
+	std::vector<std::vector<uint32_t>> levels;
+	if(numLevels == 0)
+		return levels;
+
+	levels.push_back(mesh.GetIndices());
+	while(levels.size() < numLevels)
+	{
+		const std::vector<uint32_t>& previous = levels.back();
+		const size_t target = size_t(previous.size() / 3 * reduction);
+		std::vector<uint32_t> level = Simplify(previous.data(), previous.size(), positions, mesh.GetNumVertices(), target, maxError);
+		if(level.size() >= previous.size())
+			break;
+		levels.push_back(std::move(level));
+	}
+	return levels;
+}
+
+std::vector<uint32_t> VertexFetchRemap(const uint32_t indices[], size_t numIndices, size_t numVertices)
+{
+	const uint32_t kUnused = std::numeric_limits<uint32_t>::max();
+	std::vector<uint32_t> remap(numVertices, kUnused);
+	uint32_t next = 0;
+	for(size_t i = 0; i < numIndices; ++i)
+	{
+		assert(indices[i] < numVertices);
+		if(remap[indices[i]] == kUnused)
+			remap[indices[i]] = next++;
+	}
+	for(auto& index: remap)
+	{
+		if(index == kUnused)
+			index = next++;
+	}
+	return remap;
+}
+
+namespace
+{
+
+/// Scatter elements of a fixed size to their new positions
+template<size_t size>
+void RemapElements(const uint8_t* __restrict in, uint8_t* __restrict out, const std::vector<uint32_t>& remap)
+{
+	for(size_t i = 0; i < remap.size(); ++i)
+		std::memcpy(out + size_t(remap[i]) * size, in + i * size, size);
+}
+
+void RemapElements(const uint8_t* __restrict in, uint8_t* __restrict out, size_t size, const std::vector<uint32_t>& remap)
+{
+	switch(size)
+	{
+	case 4: RemapElements<4>(in, out, remap); break;
+	case 8: RemapElements<8>(in, out, remap); break;
+	case 12: RemapElements<12>(in, out, remap); break;
+	case 16: RemapElements<16>(in, out, remap); break;
+	default:
+		for(size_t i = 0; i < remap.size(); ++i)
+			std::memcpy(out + size_t(remap[i]) * size, in + i * size, size);
+	}
+}
+
+}
+
+void RemapVertices(Mesh& mesh, const std::vector<uint32_t>& remap)
+{
+	const size_t numVertices = mesh.GetNumVertices();
+	if(remap.size() != numVertices)
+		throw std::runtime_error("RemapVertices: Remap table does not match vertex count");
+
+	// Validate everything before changing anything, so that errors leave the mesh untouched:
+	std::vector<uint8_t> used(numVertices, 0);
+	for(uint32_t target: remap)
+	{
+		if(target >= numVertices || used[target])
+			throw std::runtime_error("RemapVertices: Remap table is not a permutation");
+		used[target] = 1;
+	}
+	for(uint32_t index: mesh.GetIndices())
+	{
+		if(index >= numVertices)
+			throw std::runtime_error("RemapVertices: Index out of range");
+	}
+	for(auto& attribute: mesh.GetAttributes())
+	{
+		const size_t size = attribute.second.GetRawSize();
+		if(size != 0 && (numVertices == 0 || size % numVertices != 0))
+			throw std::runtime_error("RemapVertices: Attribute size is not a multiple of the vertex count");
+	}
+
+	for(auto& attribute: mesh.GetAttributes())
+	{
+		Mesh::Attribute& data = attribute.second;
+		const size_t size = data.GetRawSize();
+		if(size == 0)
+			continue;
+
+		Blob remapped(size);
+		RemapElements(static_cast<const uint8_t*>(data.GetRawData()), remapped.GetBytes(), size / numVertices, remap);
+		const bool normalized = data.IsNormalized();
+		data.SetData(data.GetType(), data.GetNumComponents(), std::move(remapped));
+		data.SetNormalized(normalized);
+	}
+
+	for(auto& index: mesh.GetIndices())
+		index = remap[index];
+}
+
+void OptimizeVertexFetch(Mesh& mesh)
+{
+	const auto& indices = mesh.GetIndices();
+	RemapVertices(mesh, VertexFetchRemap(indices.data(), indices.size(), mesh.GetNumVertices()));
+}
+
+namespace
+{
+
+/// Calculate bounding volumes and normal cone of a finished meshlet
+void CalculateMeshletBounds(Meshlet& meshlet, const MeshletSet& set, const Vector3 positions[])
+{
+	const uint32_t* vertices = set.vertices.data() + meshlet.vertexOffset;
+	meshlet.boundingBox = AxisAlignedBox();
+	for(uint32_t i = 0; i < meshlet.vertexCount; ++i)
+		meshlet.boundingBox.Stretch(positions[vertices[i]]);
+
+	meshlet.sphereCenter = meshlet.boundingBox.GetCenter();
+	float radiusSquared = 0;
+	for(uint32_t i = 0; i < meshlet.vertexCount; ++i)
+		radiusSquared = std::max(radiusSquared, (positions[vertices[i]] - meshlet.sphereCenter).LengthSquared());
+	meshlet.sphereRadius = std::sqrt(radiusSquared);
+
+	std::vector<Vector3> normals;
+	normals.reserve(meshlet.triangleCount);
+	Vector3 axis(0, 0, 0);
+	const uint8_t* triangles = set.triangles.data() + meshlet.triangleOffset;
+	for(uint32_t i = 0; i < meshlet.triangleCount; ++i)
+	{
+		const Vector3& p0 = positions[vertices[triangles[i * 3]]];
+		const Vector3& p1 = positions[vertices[triangles[i * 3 + 1]]];
+		const Vector3& p2 = positions[vertices[triangles[i * 3 + 2]]];
+		const Vector3 normal = (p1 - p0).CrossProduct(p2 - p0);
+		const float length = normal.Length();
+		if(length > 0)
+		{
+			normals.push_back(normal / length);
+			axis += normals.back();
+		}
+	}
+
+	// Cone is unusable if the normals cancel out or spread over more than a hemisphere:
+	meshlet.coneAxis = Vector3(0, 0, 0);
+	meshlet.coneCutoff = 2.0f;
+	const float axisLength = axis.Length();
+	if(axisLength > 0)
+	{
+		meshlet.coneAxis = axis / axisLength;
+		float minDot = 1.0f;
+		for(const Vector3& normal: normals)
+			minDot = std::min(minDot, normal.DotProduct(meshlet.coneAxis));
+		if(minDot > 0)
+			meshlet.coneCutoff = std::sqrt(std::max(0.0f, 1.0f - minDot * minDot));
+	}
+}
+
+}
+
+MeshletSet BuildMeshlets(const uint32_t indices[], size_t numIndices, const Vector3 positions[], size_t numVertices, size_t maxVertices, size_t maxTriangles)
+{
+	if(maxVertices < 3 || maxVertices > 256)
+		throw std::range_error("BuildMeshlets: maxVertices must be between 3 and 256");
+	if(maxTriangles == 0)
+		throw std::range_error("BuildMeshlets: maxTriangles must not be zero");
+
+	MeshletSet set;
+	const size_t numTriangles = numIndices / 3;
+	set.triangles.reserve(numTriangles * 3);
+	set.vertices.reserve(numVertices);
+
+	const int16_t kNotInMeshlet = -1;
+	std::vector<int16_t> localIndices(numVertices, kNotInMeshlet);
+	Meshlet meshlet = {};
+
+	auto finishMeshlet = [&]()
+	{
+		for(uint32_t i = 0; i < meshlet.vertexCount; ++i)
+			localIndices[set.vertices[meshlet.vertexOffset + i]] = kNotInMeshlet;
+		CalculateMeshletBounds(meshlet, set, positions);
+		set.meshlets.push_back(meshlet);
+		meshlet = Meshlet();
+		meshlet.vertexOffset = uint32_t(set.vertices.size());
+		meshlet.triangleOffset = uint32_t(set.triangles.size());
+		meshlet.vertexCount = 0;
+		meshlet.triangleCount = 0;
+	};
+
+	for(size_t triangle = 0; triangle < numTriangles; ++triangle)
+	{
+		const uint32_t* corners = indices + triangle * 3;
+		assert(corners[0] < numVertices && corners[1] < numVertices && corners[2] < numVertices);
+		const size_t newVertices = (localIndices[corners[0]] == kNotInMeshlet)
+				+ (localIndices[corners[1]] == kNotInMeshlet && corners[1] != corners[0])
+				+ (localIndices[corners[2]] == kNotInMeshlet && corners[2] != corners[0] && corners[2] != corners[1]);
+		if(meshlet.vertexCount + newVertices > maxVertices || meshlet.triangleCount + 1 > maxTriangles)
+			finishMeshlet();
+
+		for(size_t corner = 0; corner < 3; ++corner)
+		{
+			int16_t& local = localIndices[corners[corner]];
+			if(local == kNotInMeshlet)
+			{
+				local = int16_t(meshlet.vertexCount++);
+				set.vertices.push_back(corners[corner]);
+			}
+			set.triangles.push_back(uint8_t(local));
+		}
+		meshlet.triangleCount++;
+	}
+	if(meshlet.triangleCount > 0)
+		finishMeshlet();
+
+	return set;
+}
+
+MeshletSet BuildMeshlets(const Mesh& mesh, size_t maxVertices, size_t maxTriangles)
+{
+	const Vector3* positions = TrianglePositions(mesh, "BuildMeshlets");
+	const auto& indices = mesh.GetIndices();
+	return BuildMeshlets(indices.data(), indices.size(), positions, mesh.GetNumVertices(), maxVertices, maxTriangles);
+}
+
+namespace
+{
+
+/// Format version of EncodeIndices()
+const uint8_t kIndexCodecVersion = 0xe1;
+
+/// Code for a vertex that is the next one in first use order
+const unsigned int kNextVertex = 0;
+
+/// Code for a vertex that is encoded explicitly
+const unsigned int kExplicitVertex = 15;
+
+/// Code in the upper nibble for a triangle without a known edge
+const unsigned int kNoEdge = 15;
+
+/// Edge and vertex history shared by index encoder and decoder
+class IndexCodecState
+{
+public:
+	IndexCodecState()
+	{
+		for(auto& edge: mEdges)
+			edge[0] = edge[1] = std::numeric_limits<uint32_t>::max();
+		for(auto& vertex: mVertices)
+			vertex = std::numeric_limits<uint32_t>::max();
+	}
+
+	/// Edge, most recent first
+	const uint32_t* GetEdge(unsigned int i) const {return mEdges[(mEdgeOffset - 1 - i) & 15];}
+
+	/// Vertex, most recent first
+	uint32_t GetVertex(unsigned int i) const {return mVertices[(mVertexOffset - 1 - i) & 15];}
+
+	void PushEdge(uint32_t a, uint32_t b)
+	{
+		mEdges[mEdgeOffset & 15][0] = a;
+		mEdges[mEdgeOffset & 15][1] = b;
+		mEdgeOffset++;
+	}
+
+	void PushVertex(uint32_t v)
+	{
+		mVertices[mVertexOffset & 15] = v;
+		mVertexOffset++;
+	}
+
+	uint32_t next = 0;
+	uint32_t lastExplicit = 0;
+
+private:
+	uint32_t mEdges[16][2];
+	uint32_t mVertices[16];
+	unsigned int mEdgeOffset = 0;
+	unsigned int mVertexOffset = 0;
+};
+
+void WriteVarInt(std::vector<uint8_t>& out, uint32_t value)
+{
+	while(value >= 0x80)
+	{
+		out.push_back(uint8_t(value | 0x80));
+		value >>= 7;
+	}
+	out.push_back(uint8_t(value));
+}
+
+/// Get code for a vertex and update the history accordingly
+unsigned int EncodeVertex(IndexCodecState& state, uint32_t v, std::vector<uint32_t>& explicitVertices)
+{
+	if(v == state.next)
+	{
+		state.next++;
+		state.PushVertex(v);
+		return kNextVertex;
+	}
+	for(unsigned int i = 0; i < kExplicitVertex - 1; ++i)
+	{
+		if(state.GetVertex(i) == v)
+			return i + 1;
+	}
+	explicitVertices.push_back(v);
+	state.PushVertex(v);
+	return kExplicitVertex;
+}
+
+/// Write explicitly coded vertices as zigzag deltas
+void WriteExplicitVertices(IndexCodecState& state, std::vector<uint8_t>& out, std::vector<uint32_t>& explicitVertices)
+{
+	for(uint32_t v: explicitVertices)
+	{
+		const int32_t delta = int32_t(v - state.lastExplicit);
+		WriteVarInt(out, (uint32_t(delta) << 1) ^ uint32_t(delta >> 31));
+		state.lastExplicit = v;
+	}
+	explicitVertices.clear();
+}
+
+}
+
+std::vector<uint8_t> EncodeIndices(const uint32_t indices[], size_t numIndices)
 {
+	if(numIndices % 3 != 0)
+		throw std::range_error("EncodeIndices: Index count is not a multiple of three");
+	if(numIndices / 3 > std::numeric_limits<uint32_t>::max())
+		throw std::range_error("EncodeIndices: Triangle count does not fit into 32 bits");
 
-namespace MeshUtils
+	std::vector<uint8_t> out;
+	out.reserve(numIndices / 2 + 8);
+	out.push_back(kIndexCodecVersion);
+	WriteVarInt(out, uint32_t(numIndices / 3));
+
+	IndexCodecState state;
+	std::vector<uint32_t> explicitVertices;
+	for(size_t i = 0; i < numIndices; i += 3)
+	{
+		// Look for a rotation where the first edge is shared with a recent triangle:
+		unsigned int edge = kNoEdge;
+		size_t rotation = 0;
+		for(unsigned int e = 0; e < kNoEdge && edge == kNoEdge; ++e)
+		{
+			const uint32_t* candidate = state.GetEdge(e);
+			for(size_t r = 0; r < 3; ++r)
+			{
+				if(indices[i + r] == candidate[1] && indices[i + (r + 1) % 3] == candidate[0])
+				{
+					edge = e;
+					rotation = r;
+					break;
+				}
+			}
+		}
+
+		const uint32_t a = indices[i + rotation];
+		const uint32_t b = indices[i + (rotation + 1) % 3];
+		const uint32_t c = indices[i + (rotation + 2) % 3];
+		if(edge != kNoEdge)
+		{
+			out.push_back(uint8_t(edge << 4 | EncodeVertex(state, c, explicitVertices)));
+			state.PushEdge(b, c);
+			state.PushEdge(c, a);
+		}
+		else
+		{
+			const unsigned int codeA = EncodeVertex(state, a, explicitVertices);
+			const unsigned int codeB = EncodeVertex(state, b, explicitVertices);
+			const unsigned int codeC = EncodeVertex(state, c, explicitVertices);
+			out.push_back(uint8_t(kNoEdge << 4 | codeA));
+			out.push_back(uint8_t(codeB << 4 | codeC));
+			state.PushEdge(a, b);
+			state.PushEdge(b, c);
+			state.PushEdge(c, a);
+		}
+		WriteExplicitVertices(state, out, explicitVertices);
+	}
+	return out;
+}
+
+namespace
+{
+
+/// Byte reader for encoded indices and vertices, throwing on truncated data
+class CodecReader
+{
+public:
+	CodecReader(const uint8_t* data, size_t size) : mPointer(data), mEnd(data + size) {}
+
+	uint8_t ReadByte()
+	{
+		if(mPointer == mEnd)
+			throw std::runtime_error("MeshUtils: Truncated data");
+		return *mPointer++;
+	}
+
+	uint32_t ReadVarInt()
+	{
+		uint32_t value = 0;
+		for(unsigned int shift = 0; shift < 35; shift += 7)
+		{
+			const uint8_t byte = ReadByte();
+			value |= uint32_t(byte & 0x7f) << shift;
+			if(!(byte & 0x80))
+				return value;
+		}
+		throw std::runtime_error("MeshUtils: Malformed variable length integer");
+	}
+
+	/// Get pointer to the next count bytes and skip them
+	const uint8_t* Read(size_t count)
+	{
+		if(size_t(mEnd - mPointer) < count)
+			throw std::runtime_error("MeshUtils: Truncated data");
+		const uint8_t* data = mPointer;
+		mPointer += count;
+		return data;
+	}
+
+	bool AtEnd() const {return mPointer == mEnd;}
+	size_t GetRemaining() const {return size_t(mEnd - mPointer);}
+
+private:
+	const uint8_t* mPointer;
+	const uint8_t* mEnd;
+};
+
+inline uint32_t DecodeVertex(IndexCodecState& state, CodecReader& reader, unsigned int code)
+{
+	if(code == kNextVertex)
+	{
+		const uint32_t v = state.next++;
+		state.PushVertex(v);
+		return v;
+	}
+	else if(code == kExplicitVertex)
+	{
+		const uint32_t zigzag = reader.ReadVarInt();
+		const uint32_t v = state.lastExplicit + ((zigzag >> 1) ^ (0u - (zigzag & 1)));
+		state.lastExplicit = v;
+		state.PushVertex(v);
+		return v;
+	}
+	return state.GetVertex(code - 1);
+}
+
+}
+
+void DecodeIndices(const void* data, size_t size, std::vector<uint32_t>& outIndices)
+{
+	CodecReader reader(static_cast<const uint8_t*>(data), size);
+	if(reader.ReadByte() != kIndexCodecVersion)
+		throw std::runtime_error("DecodeIndices: Unknown format version");
+	const size_t numTriangles = reader.ReadVarInt();
+	if(numTriangles > size)
+		throw std::runtime_error("DecodeIndices: Triangle count exceeds data size");
+
+	const size_t offset = outIndices.size();
+	outIndices.resize(offset + numTriangles * 3);
+	uint32_t* out = outIndices.data() + offset;
+	IndexCodecState state;
+	for(size_t i = 0; i < numTriangles; ++i, out += 3)
+	{
+		const uint8_t code = reader.ReadByte();
+		const unsigned int edge = code >> 4;
+		if(edge != kNoEdge)
+		{
+			const uint32_t* shared = state.GetEdge(edge);
+			const uint32_t a = shared[1];
+			const uint32_t b = shared[0];
+			const uint32_t c = DecodeVertex(state, reader, code & 15);
+			out[0] = a;
+			out[1] = b;
+			out[2] = c;
+			state.PushEdge(b, c);
+			state.PushEdge(c, a);
+		}
+		else
+		{
+			const uint8_t codes = reader.ReadByte();
+			// Explicit vertices follow in the order a, b, c:
+			const uint32_t a = DecodeVertex(state, reader, code & 15);
+			const uint32_t b = DecodeVertex(state, reader, codes >> 4);
+			const uint32_t c = DecodeVertex(state, reader, codes & 15);
+			out[0] = a;
+			out[1] = b;
+			out[2] = c;
+			state.PushEdge(a, b);
+			state.PushEdge(b, c);
+			state.PushEdge(c, a);
+		}
+	}
+	if(!reader.AtEnd())
+		throw std::runtime_error("DecodeIndices: Trailing data");
+}
+
+namespace
+{
+
+/// Format version of EncodeVertexData()
+const uint8_t kVertexCodecVersion = 0xa1;
+
+/// Vertices per block, each byte lane of a block is encoded separately
+const size_t kVertexBlockSize = 256;
+
+/// Deltas sharing a bit width
+const size_t kVertexGroupSize = 16;
+
+/// Bit widths selectable by the 2 bit group header
+const unsigned int kGroupBitWidths[4] = {0, 2, 4, 8};
+
+inline uint8_t ZigZag8(uint8_t delta)
+{
+	return uint8_t((delta << 1) ^ uint8_t(int8_t(delta) >> 7));
+}
+
+inline uint8_t UnZigZag8(uint8_t value)
+{
+	return uint8_t((value >> 1) ^ (0 - (value & 1)));
+}
+
+/// Encode one byte lane of a block
+/** @param last Previous value of this lane, updated. */
+void EncodeVertexLane(const uint8_t* lane, size_t count, uint8_t& last, std::vector<uint8_t>& out)
+{
+	const size_t numGroups = (count + kVertexGroupSize - 1) / kVertexGroupSize;
+	const size_t headerOffset = out.size();
+	out.resize(out.size() + (numGroups + 3) / 4, 0);
+
+	uint8_t zigzag[kVertexGroupSize];
+	for(size_t group = 0; group < numGroups; ++group)
+	{
+		uint8_t bitsUsed = 0;
+		for(size_t i = 0; i < kVertexGroupSize; ++i)
+		{
+			// Padding repeats the last value, so the delta is zero:
+			const size_t index = group * kVertexGroupSize + i;
+			const uint8_t value = index < count ? lane[index] : last;
+			zigzag[i] = ZigZag8(uint8_t(value - last));
+			bitsUsed |= zigzag[i];
+			last = value;
+		}
+
+		unsigned int header = 3;
+		while(header > 0 && bitsUsed < (1u << kGroupBitWidths[header - 1]))
+			header--;
+		out[headerOffset + group / 4] |= uint8_t(header << ((group % 4) * 2));
+
+		// Values are packed starting at the lowest bits of each byte:
+		const unsigned int bits = kGroupBitWidths[header];
+		if(bits == 0)
+			continue;
+		const unsigned int perByte = 8 / bits;
+		for(size_t i = 0; i < kVertexGroupSize; i += perByte)
+		{
+			uint8_t byte = 0;
+			for(unsigned int j = 0; j < perByte; ++j)
+				byte |= uint8_t(zigzag[i + j] << (j * bits));
+			out.push_back(byte);
+		}
+	}
+}
+
+#if MOLECULAR_MESHUTILS_SSE2
+/// Unpack 16 zigzag deltas with the given header
+inline __m128i UnpackVertexGroup(unsigned int header, const uint8_t* payload)
+{
+	switch(header)
+	{
+	case 1:
+	{
+		int bytes;
+		std::memcpy(&bytes, payload, 4);
+		const __m128i x = _mm_cvtsi32_si128(bytes);
+		const __m128i mask = _mm_set1_epi8(3);
+		const __m128i p0 = _mm_and_si128(x, mask);
+		const __m128i p1 = _mm_and_si128(_mm_srli_epi16(x, 2), mask);
+		const __m128i p2 = _mm_and_si128(_mm_srli_epi16(x, 4), mask);
+		const __m128i p3 = _mm_and_si128(_mm_srli_epi16(x, 6), mask);
+		return _mm_unpacklo_epi16(_mm_unpacklo_epi8(p0, p1), _mm_unpacklo_epi8(p2, p3));
+	}
+	case 2:
+	{
+		const __m128i x = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(payload));
+		const __m128i mask = _mm_set1_epi8(15);
+		return _mm_unpacklo_epi8(_mm_and_si128(x, mask), _mm_and_si128(_mm_srli_epi16(x, 4), mask));
+	}
+	case 3:
+		return _mm_loadu_si128(reinterpret_cast<const __m128i*>(payload));
+	default:
+		return _mm_setzero_si128();
+	}
+}
+
+/// Decode a group of 16 values
+/** @param last Previous value, updated. */
+inline void DecodeVertexGroup(unsigned int header, const uint8_t* payload, uint8_t* out, uint8_t& last)
+{
+	const __m128i zigzag = UnpackVertexGroup(header, payload);
+	const __m128i sign = _mm_sub_epi8(_mm_setzero_si128(), _mm_and_si128(zigzag, _mm_set1_epi8(1)));
+	__m128i x = _mm_xor_si128(_mm_and_si128(_mm_srli_epi16(zigzag, 1), _mm_set1_epi8(0x7f)), sign);
+
+	// Prefix sum:
+	x = _mm_add_epi8(x, _mm_slli_si128(x, 1));
+	x = _mm_add_epi8(x, _mm_slli_si128(x, 2));
+	x = _mm_add_epi8(x, _mm_slli_si128(x, 4));
+	x = _mm_add_epi8(x, _mm_slli_si128(x, 8));
+	x = _mm_add_epi8(x, _mm_set1_epi8(char(last)));
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(out), x);
+	last = uint8_t(_mm_cvtsi128_si32(_mm_srli_si128(x, 15)));
+}
+#else
+/// Decode a group of 16 values
+/** @param last Previous value, updated. */
+inline void DecodeVertexGroup(unsigned int header, const uint8_t* payload, uint8_t* out, uint8_t& last)
+{
+	const unsigned int bits = kGroupBitWidths[header];
+	const uint8_t mask = uint8_t((1u << bits) - 1);
+	uint8_t value = last;
+	for(size_t i = 0; i < kVertexGroupSize; ++i)
+	{
+		const uint8_t zigzag = bits ? uint8_t((payload[i * bits / 8] >> (i * bits % 8)) & mask) : 0;
+		value = uint8_t(value + UnZigZag8(zigzag));
+		out[i] = value;
+	}
+	last = value;
+}
+#endif
+
+}
+
+std::vector<uint8_t> EncodeVertexData(const void* data, size_t size, size_t elementSize)
+{
+	if(elementSize == 0 || size % elementSize != 0)
+		throw std::range_error("EncodeVertexData: Size is not a multiple of the element size");
+
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	const size_t count = size / elementSize;
+	if(elementSize > std::numeric_limits<uint32_t>::max() || count > std::numeric_limits<uint32_t>::max())
+		throw std::range_error("EncodeVertexData: Element size or count does not fit into 32 bits");
+	std::vector<uint8_t> out;
+	out.reserve(size / 2 + 16);
+	out.push_back(kVertexCodecVersion);
+	WriteVarInt(out, uint32_t(elementSize));
+	WriteVarInt(out, uint32_t(count));
+
+	std::vector<uint8_t> last(elementSize, 0);
+	uint8_t lane[kVertexBlockSize];
+	for(size_t blockStart = 0; blockStart < count; blockStart += kVertexBlockSize)
+	{
+		const size_t blockCount = std::min(kVertexBlockSize, count - blockStart);
+		for(size_t byte = 0; byte < elementSize; ++byte)
+		{
+			for(size_t i = 0; i < blockCount; ++i)
+				lane[i] = bytes[(blockStart + i) * elementSize + byte];
+			EncodeVertexLane(lane, blockCount, last[byte], out);
+		}
+	}
+	return out;
+}
+
+std::vector<uint8_t> EncodeVertexData(const Mesh::Attribute& attribute)
+{
+	const size_t elementSize = VertexAttributeInfo::GetTypeSize(attribute.GetType()) * attribute.GetNumComponents();
+	return EncodeVertexData(attribute.GetRawData(), attribute.GetRawSize(), elementSize);
+}
+
+void DecodeVertexData(const void* data, size_t size, std::vector<uint8_t>& outData)
 {
+	CodecReader reader(static_cast<const uint8_t*>(data), size);
+	if(reader.ReadByte() != kVertexCodecVersion)
+		throw std::runtime_error("DecodeVertexData: Unknown format version");
+	const size_t elementSize = reader.ReadVarInt();
+	const size_t count = reader.ReadVarInt();
+
+	// Check before allocating: Each lane of each block has one header byte per four groups.
+	const size_t numLastGroups = (count % kVertexBlockSize + kVertexGroupSize - 1) / kVertexGroupSize;
+	const size_t headerBytesPerLane = count / kVertexBlockSize * (kVertexBlockSize / kVertexGroupSize / 4) + (numLastGroups + 3) / 4;
+	if(elementSize == 0 || (count != 0 && (elementSize > reader.GetRemaining() || headerBytesPerLane > reader.GetRemaining() / elementSize)))
+		throw std::runtime_error("DecodeVertexData: Element size or count exceeds data size");
+
+	outData.resize(count * elementSize);
+	uint8_t* out = outData.data();
+	uint8_t lanes[kVertexBlockSize];
+	std::vector<uint8_t> last(count != 0 ? elementSize : 0, 0);
+	for(size_t blockStart = 0; blockStart < count; blockStart += kVertexBlockSize)
+	{
+		const size_t blockCount = std::min(kVertexBlockSize, count - blockStart);
+		const size_t numGroups = (blockCount + kVertexGroupSize - 1) / kVertexGroupSize;
+		for(size_t byte = 0; byte < elementSize; ++byte)
+		{
+			const uint8_t* headers = reader.Read((numGroups + 3) / 4);
+			for(size_t group = 0; group < numGroups; ++group)
+			{
+				const unsigned int header = (headers[group / 4] >> ((group % 4) * 2)) & 3;
+				const uint8_t* payload = reader.Read(kGroupBitWidths[header] * kVertexGroupSize / 8);
+				DecodeVertexGroup(header, payload, lanes + group * kVertexGroupSize, last[byte]);
+			}
+
+			uint8_t* target = out + blockStart * elementSize + byte;
+			for(size_t i = 0; i < blockCount; ++i)
+				target[i * elementSize] = lanes[i];
+		}
+	}
+	if(!reader.AtEnd())
+		throw std::runtime_error("DecodeVertexData: Trailing data");
+}
 
 void Interleave(size_t count, size_t datumSize0, size_t datumSize1, void* const data0, void* const data1, void* __restrict outData)
 {
-	const uint8_t* bytes0 = static_cast<const uint8_t*>(data0);
-	const uint8_t* bytes1 = static_cast<const uint8_t*>(data1);
-	uint8_t* outBytes = static_cast<uint8_t*>(outData);
+	const void* const data[] = {data0, data1};
+	const size_t datumSizes[] = {datumSize0, datumSize1};
+	const size_t offsets[] = {0, datumSize0};
+	Interleave(count, 2, data, datumSizes, offsets, datumSize0 + datumSize1, outData);
+}
+
+namespace
+{
 
-	size_t stride = datumSize0 + datumSize1;
+/// Vertices interleaved per stream before moving on to the next block
+/** Keeps the written part of the output in cache while it is visited by every stream. */
+const size_t kInterleaveBlockSize = 1024;
+
+/// Copy tightly packed elements of compile time size to strided destination
+/** Fixed size copies compile to one or two vector moves instead of a memcpy call. */
+template<size_t size>
+void CopyToStrided(size_t count, const uint8_t* __restrict in, uint8_t* __restrict out, size_t stride)
+{
 	for(size_t i = 0; i < count; ++i)
+		std::memcpy(out + i * stride, in + i * size, size);
+}
+
+void CopyToStrided(size_t count, size_t size, const uint8_t* __restrict in, uint8_t* __restrict out, size_t stride)
+{
+	switch(size)
+	{
+	case 4: CopyToStrided<4>(count, in, out, stride); break;
+	case 8: CopyToStrided<8>(count, in, out, stride); break;
+	case 12: CopyToStrided<12>(count, in, out, stride); break;
+	case 16: CopyToStrided<16>(count, in, out, stride); break;
+	default:
+		for(size_t i = 0; i < count; ++i)
+			std::memcpy(out + i * stride, in + i * size, size);
+	}
+}
+
+}
+
+void Interleave(size_t count, size_t numStreams, const void* const data[], const size_t datumSizes[], const size_t offsets[], size_t stride, void* __restrict outData)
+{
+	uint8_t* outBytes = static_cast<uint8_t*>(outData);
+	for(size_t blockStart = 0; blockStart < count; blockStart += kInterleaveBlockSize)
+	{
+		const size_t blockCount = std::min(kInterleaveBlockSize, count - blockStart);
+		for(size_t stream = 0; stream < numStreams; ++stream)
+		{
+			const uint8_t* in = static_cast<const uint8_t*>(data[stream]) + blockStart * datumSizes[stream];
+			uint8_t* out = outBytes + blockStart * stride + offsets[stream];
+			CopyToStrided(blockCount, datumSizes[stream], in, out, stride);
+		}
+	}
+}
+
+InterleavedVertexData Interleave(const Mesh& mesh, size_t alignment)
+{
+	if(alignment == 0 || (alignment & (alignment - 1)) != 0)
+		throw std::range_error("Interleave: Alignment is not a power of two");
+
+	const size_t numVertices = mesh.GetNumVertices();
+	std::vector<std::pair<Hash, const Mesh::Attribute*>> attributes;
+	for(auto& attribute: mesh.GetAttributes())
+	{
+		const size_t size = VertexAttributeInfo::GetTypeSize(attribute.second.GetType()) * attribute.second.GetNumComponents();
+		if(attribute.second.GetRawSize() != size * numVertices)
+			throw std::range_error("Interleave: Attribute size does not match number of vertices");
+		attributes.emplace_back(attribute.first, &attribute.second);
+	}
+	std::sort(attributes.begin(), attributes.end(), [](auto& a, auto& b){
+		const size_t sizeA = VertexAttributeInfo::GetTypeSize(a.second->GetType());
+		const size_t sizeB = VertexAttributeInfo::GetTypeSize(b.second->GetType());
+		return sizeA != sizeB ? sizeA > sizeB : a.first < b.first;
+	});
+
+	InterleavedVertexData result;
+	std::vector<const void*> data;
+	std::vector<size_t> datumSizes, offsets;
+	for(auto& attribute: attributes)
 	{
-		std::memcpy(outBytes + stride * i, bytes0 + datumSize0 * i, datumSize0);
-		std::memcpy(outBytes + stride * i + datumSize0, bytes1 + datumSize1 * i, datumSize1);
+		const Mesh::Attribute& attr = *attribute.second;
+		const VertexAttributeInfo::Type type = attr.GetType();
+		VertexAttributeInfo info(type, attr.GetNumComponents(), int(result.stride), 0, 0, attr.IsNormalized());
+		info.semantic = attribute.first;
+		result.attributes.push_back(info);
+
+		data.push_back(attr.GetRawData());
+		datumSizes.push_back(VertexAttributeInfo::GetTypeSize(type) * attr.GetNumComponents());
+		offsets.push_back(result.stride);
+		result.stride = (result.stride + datumSizes.back() + alignment - 1) & ~(alignment - 1);
 	}
+	for(auto& info: result.attributes)
+		info.stride = int(result.stride);
+
+	// Zero padding bytes:
+	result.data.resize(result.stride * numVertices, 0);
+	Interleave(numVertices, data.size(), data.data(), datumSizes.data(), offsets.data(), result.stride, result.data.data());
+	return result;
 }
 
 template<typename T>
@@ -75,10 +1683,13 @@ template void QuadToTriangleIndices<uint32_t>(size_t quadCount, const uint32_t i
 
 void Scale(Mesh& mesh, float scaleFactor)
 {
-	Vector3* positions = mesh.GetAttribute(VertexAttributeInfo::kPosition).GetData<Vector3>();
-	unsigned int numVertices = mesh.GetNumVertices();
-	for(unsigned int i = 0; i < numVertices; ++i)
-		positions[i] *= scaleFactor;
+	Scale(mesh.GetAttribute(VertexAttributeInfo::kPosition).GetView<Vector3>(), scaleFactor);
+}
+
+void Scale(StridedView<Vector3> positions, float scaleFactor)
+{
+	for(auto& position: positions)
+		position *= scaleFactor;
 }
 
 Vector3 TriangleNormal(const Vector3& p1, const Vector3& p2, const Vector3& p3)
@@ -90,24 +1701,32 @@ Vector3 TriangleNormal(const Vector3& p1, const Vector3& p2, const Vector3& p3)
 
 std::vector<Vector3> IndexedTriangleNormals(const std::vector<Vector3>& positions, const int triangleIndices[], size_t triangleCount)
 {
-	std::vector<Vector3> normals(positions.size(), Vector3(0, 0, 0));
+	std::vector<Vector3> normals(positions.size());
+	IndexedTriangleNormals(MakeStridedView(positions.data(), positions.size()), triangleIndices, triangleCount, MakeStridedView(normals.data(), normals.size()));
+	return normals;
+}
+
+void IndexedTriangleNormals(StridedView<const Vector3> positions, const int triangleIndices[], size_t triangleCount, StridedView<Vector3> outNormals)
+{
+	if(outNormals.size() < positions.size())
+		throw std::range_error("IndexedTriangleNormals: Output smaller than positions");
+
+	for(auto& normal: outNormals)
+		normal = Vector3(0, 0, 0);
 	for(size_t i = 0; i < triangleCount; ++i)
 	{
 		unsigned int idx1 = triangleIndices[i * 3];
 		unsigned int idx2 = triangleIndices[i * 3 + 1];
 		unsigned int idx3 = triangleIndices[i * 3 + 2];
-		Vector3 p1 = positions.at(idx1);
-		Vector3 p2 = positions.at(idx2);
-		Vector3 p3 = positions.at(idx3);
-		Vector3 normal = TriangleNormal(p1, p2, p3);
-		normals[idx1] += normal;
-		normals[idx2] += normal;
-		normals[idx3] += normal;
+		if(idx1 >= positions.size() || idx2 >= positions.size() || idx3 >= positions.size())
+			throw std::out_of_range("IndexedTriangleNormals: Index out of range");
+		Vector3 normal = TriangleNormal(positions[idx1], positions[idx2], positions[idx3]);
+		outNormals[idx1] += normal;
+		outNormals[idx2] += normal;
+		outNormals[idx3] += normal;
 	}
-	for(auto& normal: normals)
+	for(auto& normal: outNormals)
 		normal = normal.Normalized();
-
-	return normals;
 }
 
 std::vector<int> TriangleNeighbours(const int triangleIndices[], unsigned int triangleCount)
@@ -145,55 +1764,220 @@ std::vector<int> TriangleNeighbours(const int triangleIndices[], unsigned int tr
 
 void Transform(Mesh& mesh, const Matrix4& transform)
 {
+	StridedView<Vector3> positions, normals;
 	for(auto& attribute: mesh.GetAttributes())
 	{
 		if(attribute.first == VertexAttributeInfo::kPosition)
-		{
-			Vector3* positionData = attribute.second.GetData<Vector3>();
-			for(unsigned int i = 0; i < mesh.GetNumVertices(); ++i)
-			{
-				Vector4 p = transform * Vector4(positionData[i], 1.0f);
-				positionData[i] = Vector3(p[0] / p[3], p[1] / p[3], p[2] / p[3]);
-			}
-		}
+			positions = attribute.second.GetView<Vector3>();
 		else if(attribute.first == VertexAttributeInfo::kNormal)
-		{
-			Vector3* normalData = attribute.second.GetData<Vector3>();
-			for(unsigned int i = 0; i < mesh.GetNumVertices(); ++i)
-			{
-				Vector4 p = transform * Vector4(normalData[i], 0.0f);
-				normalData[i] = Vector3(p[0] / p[3], p[1] / p[3], p[2] / p[3]);
-			}
-		}
+			normals = attribute.second.GetView<Vector3>();
 	}
+	Transform(positions, normals, transform);
 }
 
-void ReducePrecision(Mesh& mesh, const std::unordered_set<Hash>& toHalf, const std::unordered_set<Hash>& toInt8)
+void Transform(StridedView<Vector3> positions, StridedView<Vector3> normals, const Matrix4& transform)
 {
-	FloatToHalf fth;
+	for(auto& position: positions)
+	{
+		Vector4 p = transform * Vector4(position, 1.0f);
+		position = Vector3(p[0] / p[3], p[1] / p[3], p[2] / p[3]);
+	}
 
-	auto& attributes = mesh.GetAttributes();
-	for(auto& attribute: attributes)
+	// Directions have w = 0, so there is no perspective division:
+	for(auto& normal: normals)
+	{
+		Vector4 p = transform * Vector4(normal, 0.0f);
+		normal = Vector3(p[0], p[1], p[2]);
+	}
+}
+
+void ReducePrecision(Mesh& mesh, const std::unordered_set<Hash>& toHalf, const std::unordered_set<Hash>& toInt8)
+{
+	// Attributes of other types are skipped instead of rejected:
+	std::unordered_map<Hash, Quantization> modes;
+	for(auto& attribute: mesh.GetAttributes())
 	{
 		if(toHalf.count(attribute.first) && attribute.second.GetType() == VertexAttributeInfo::kFloat)
+			modes[attribute.first] = Quantization::kHalf;
+		else if(toInt8.count(attribute.first) && attribute.second.GetType() == VertexAttributeInfo::kInt32)
+			modes[attribute.first] = Quantization::kInt8;
+	}
+	ReducePrecision(mesh, modes);
+}
+
+Vector2 OctahedralEncode(const Vector3& v)
+{
+	const float l1 = std::abs(v[0]) + std::abs(v[1]) + std::abs(v[2]);
+	if(l1 == 0)
+		return Vector2(0, 0);
+
+	float x = v[0] / l1;
+	float y = v[1] / l1;
+	if(v[2] < 0)
+	{
+		// Fold lower hemisphere over the diagonals:
+		const float foldedX = (1.0f - std::abs(y)) * (x >= 0 ? 1.0f : -1.0f);
+		const float foldedY = (1.0f - std::abs(x)) * (y >= 0 ? 1.0f : -1.0f);
+		x = foldedX;
+		y = foldedY;
+	}
+	return Vector2(x, y);
+}
+
+Vector3 OctahedralDecode(const Vector2& e)
+{
+	Vector3 v(e[0], e[1], 1.0f - std::abs(e[0]) - std::abs(e[1]));
+	if(v[2] < 0)
+	{
+		const float x = v[0];
+		v[0] = (1.0f - std::abs(v[1])) * (x >= 0 ? 1.0f : -1.0f);
+		v[1] = (1.0f - std::abs(x)) * (v[1] >= 0 ? 1.0f : -1.0f);
+	}
+	return v.Normalized();
+}
+
+namespace
+{
+
+/// Encode float unit vectors with numComponents components as signed normalized octahedral coordinates
+template<typename T>
+std::vector<T> OctahedralQuantize(const float* data, size_t count, unsigned int numComponents)
+{
+	const float kMax = float(std::numeric_limits<T>::max());
+	const unsigned int outComponents = numComponents - 1;
+	std::vector<T> out(count * outComponents);
+	for(size_t i = 0; i < count; ++i)
+	{
+		const float* in = data + i * numComponents;
+		const Vector2 e = OctahedralEncode(Vector3(in[0], in[1], in[2]));
+		out[i * outComponents] = T(std::lround(e[0] * kMax));
+		out[i * outComponents + 1] = T(std::lround(e[1] * kMax));
+		if(numComponents == 4)
+			out[i * outComponents + 2] = in[3] < 0 ? T(-kMax) : T(kMax);
+	}
+	return out;
+}
+
+}
+
+Matrix4 ReducePrecision(Mesh& mesh, const std::unordered_map<Hash, Quantization>& modes)
+{
+	// Validate everything before converting anything, so that errors leave the mesh untouched:
+	bool boxQuantized = false;
+	for(auto& attribute: mesh.GetAttributes())
+	{
+		auto mode = modes.find(attribute.first);
+		if(mode == modes.end())
+			continue;
+
+		const Mesh::Attribute& data = attribute.second;
+		const unsigned int numComponents = data.GetNumComponents();
+		if(mode->second == Quantization::kInt8)
 		{
-			const float* floatData = static_cast<const float*>(attribute.second.GetRawData());
-			size_t floatCount = attribute.second.GetRawSize() / 4;
-			std::vector<uint16_t> halfData(floatCount);
-			for(size_t i = 0; i < floatCount; i++)
-				halfData[i] = fth.Convert(floatData[i]);
-			attribute.second.SetData(VertexAttributeInfo::kHalf, attribute.second.GetNumComponents(), halfData.data(), floatCount * 2);
+			if(data.GetType() != VertexAttributeInfo::kInt32)
+				throw std::runtime_error("ReducePrecision: Attribute is not 32 bit integer");
 		}
-		else if(toInt8.count(attribute.first) && attribute.second.GetType() == VertexAttributeInfo::kInt32)
+		else if(data.GetType() != VertexAttributeInfo::kFloat)
+			throw std::runtime_error("ReducePrecision: Attribute is not float");
+		else if((mode->second == Quantization::kOctahedral8 || mode->second == Quantization::kOctahedral16) && numComponents != 3 && numComponents != 4)
+			throw std::runtime_error("ReducePrecision: Octahedral encoding requires three or four components");
+		else if(mode->second == Quantization::kBoxUNorm16)
+		{
+			if(numComponents != 3)
+				throw std::runtime_error("ReducePrecision: Box quantization requires three components");
+			if(boxQuantized)
+				throw std::runtime_error("ReducePrecision: Only one attribute can be box quantized");
+			boxQuantized = true;
+		}
+	}
+
+	Matrix4 dequantization;
+	for(auto& attribute: mesh.GetAttributes())
+	{
+		auto mode = modes.find(attribute.first);
+		if(mode == modes.end())
+			continue;
+
+		Mesh::Attribute& data = attribute.second;
+		const unsigned int numComponents = data.GetNumComponents();
+		if(mode->second == Quantization::kInt8)
 		{
-			const int32_t* intData = static_cast<const int32_t*>(attribute.second.GetRawData());
-			size_t intCount = attribute.second.GetRawSize() / 4;
+			const int32_t* intData = static_cast<const int32_t*>(data.GetRawData());
+			const size_t intCount = data.GetRawSize() / 4;
 			std::vector<int8_t> int8Data(intCount);
 			for(size_t i = 0; i < intCount; i++)
 				int8Data[i] = int8_t(intData[i]);
-			attribute.second.SetData(VertexAttributeInfo::kInt8, attribute.second.GetNumComponents(), int8Data.data(), intCount);
+			data.SetData(VertexAttributeInfo::kInt8, numComponents, int8Data.data(), intCount);
+			continue;
+		}
+
+		const float* floatData = static_cast<const float*>(data.GetRawData());
+		const size_t floatCount = data.GetRawSize() / 4;
+		switch(mode->second)
+		{
+		case Quantization::kHalf:
+		{
+			FloatToHalf fth;
+			std::vector<uint16_t> halfData(floatCount);
+			for(size_t i = 0; i < floatCount; i++)
+				halfData[i] = fth.Convert(floatData[i]);
+			data.SetData(VertexAttributeInfo::kHalf, numComponents, halfData.data(), floatCount * 2);
+			break;
+		}
+
+		case Quantization::kOctahedral8:
+		case Quantization::kOctahedral16:
+		{
+			const size_t count = floatCount / numComponents;
+			if(mode->second == Quantization::kOctahedral8)
+			{
+				std::vector<int8_t> encoded = OctahedralQuantize<int8_t>(floatData, count, numComponents);
+				data.SetData(VertexAttributeInfo::kInt8, numComponents - 1, encoded.data(), encoded.size());
+			}
+			else
+			{
+				std::vector<int16_t> encoded = OctahedralQuantize<int16_t>(floatData, count, numComponents);
+				data.SetData(VertexAttributeInfo::kInt16, numComponents - 1, encoded.data(), encoded.size() * 2);
+			}
+			data.SetNormalized(true);
+			break;
+		}
+
+		case Quantization::kBoxUNorm16:
+		{
+			const Vector3* positions = static_cast<const Vector3*>(data.GetRawData());
+			const size_t count = floatCount / 3;
+			AxisAlignedBox box;
+			for(size_t i = 0; i < count; ++i)
+				box.Stretch(positions[i]);
+			if(count == 0)
+				box = AxisAlignedBox(Vector3(0, 0, 0), Vector3(0, 0, 0));
+
+			// Flat extents keep a scale of 1 to avoid dividing by zero:
+			Vector3 size = box.GetSize();
+			for(int c = 0; c < 3; ++c)
+				size[c] = size[c] > 0 ? size[c] : 1.0f;
+
+			std::vector<uint16_t> quantized(floatCount);
+			for(size_t i = 0; i < count; ++i)
+			{
+				for(int c = 0; c < 3; ++c)
+				{
+					const float normalized = (positions[i][c] - box.GetMin(c)) / size[c];
+					quantized[i * 3 + c] = uint16_t(std::lround(std::min(std::max(normalized, 0.0f), 1.0f) * 65535.0f));
+				}
+			}
+			data.SetData(VertexAttributeInfo::kUInt16, 3, quantized.data(), quantized.size() * 2);
+			data.SetNormalized(true);
+			dequantization = Matrix4::Translation(box.GetMin()) * Matrix4::Scale(size[0], size[1], size[2]);
+			break;
+		}
+
+		default:
+			break;
 		}
 	}
+	return dequantization;
 }
 
 } // namespace MeshUtils
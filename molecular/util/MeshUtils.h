@@ -28,10 +28,18 @@ SOFTWARE.
 
 #include "Mesh.h"
 
+#include <molecular/util/AxisAlignedBox.h>
+#include <molecular/util/FlatHashMap.h>
+#include <molecular/util/ParallelFor.h>
+#include <molecular/util/TaskDispatcher.h>
 #include <molecular/util/Vector3.h>
 #include <molecular/util/Matrix4.h>
+#include <molecular/util/StridedView.h>
 
+#include <algorithm>
+#include <limits>
 #include <vector>
+#include <unordered_map>
 #include <unordered_set>
 
 namespace molecular
@@ -42,6 +50,85 @@ namespace util
 /// Various functions for mesh data processing
 namespace MeshUtils
 {
+/// Key for unifying three attribute indices
+struct IndexTriple
+{
+	uint32_t index0, index1, index2;
+
+	bool operator==(const IndexTriple& other) const
+	{
+		return index0 == other.index0 && index1 == other.index1 && index2 == other.index2;
+	}
+};
+
+/// Hash function object for IndexTriple
+struct IndexTripleHash
+{
+	size_t operator()(const IndexTriple& key) const
+	{
+		const uint64_t packed = (static_cast<uint64_t>(key.index0) << 32) | key.index1;
+		return FlatHash<uint64_t>()(packed + key.index2 * 0x9e3779b97f4a7c15ULL);
+	}
+};
+
+/// Reusable memory for SeparateToUnifiedIndices()
+/** Passing the same instance to consecutive calls avoids reallocating the
+	lookup tables. Not thread-safe, use one instance per thread. */
+struct UnifiedIndicesScratch
+{
+	FlatHashMap<uint64_t, uint32_t> vertexMap;
+	FlatHashMap<IndexTriple, uint32_t, IndexTripleHash> tripleVertexMap;
+};
+
+/// Cluster of triangles with bounded vertex and triangle counts
+/** @see BuildMeshlets() */
+struct Meshlet
+{
+	/// Offset of the first vertex in MeshletSet::vertices
+	uint32_t vertexOffset;
+
+	/// Offset of the first local index in MeshletSet::triangles
+	uint32_t triangleOffset;
+
+	uint32_t vertexCount;
+	uint32_t triangleCount;
+
+	AxisAlignedBox boundingBox;
+
+	/// Bounding sphere enclosing all vertices
+	Vector3 sphereCenter;
+	float sphereRadius;
+
+	/// Average normal direction of the triangles, normalized
+	Vector3 coneAxis;
+
+	/// Sine of the maximum angle between coneAxis and a triangle normal
+	/** Greater than 1 if the triangles do not face a common direction. */
+	float coneCutoff;
+
+	/// Returns true if all triangles are facing away from the camera
+	/** Conservative test based on the normal cone and the bounding sphere. */
+	bool IsBackfacing(const Vector3& cameraPosition) const
+	{
+		if(coneCutoff > 1.0f)
+			return false;
+		const Vector3 direction = sphereCenter - cameraPosition;
+		return direction.DotProduct(coneAxis) >= coneCutoff * direction.Length() + (1.0f + coneCutoff) * sphereRadius;
+	}
+};
+
+/// Meshlets sharing vertex and local index buffers
+struct MeshletSet
+{
+	std::vector<Meshlet> meshlets;
+
+	/// Indices into the original vertex buffers, referenced by Meshlet::vertexOffset
+	std::vector<uint32_t> vertices;
+
+	/// Three local indices per triangle, relative to Meshlet::vertexOffset
+	std::vector<uint8_t> triangles;
+};
+
 /// Convert seperate indices as found in OBJ files to unified ones
 /** In OBJ and COLLADA files, each face has individual indices to the vertex, normal
 	and UV buffers. OpenGL only allows for the same index to each buffer,
@@ -63,6 +150,20 @@ void SeparateToUnifiedIndices(
 		std::vector<Attribute0>& outAttributes0,
 		std::vector<Attribute1>& outAttributes1);
 
+/// Convert seperate indices as found in OBJ files to unified ones
+/** This is an overloaded function. Variant for two attributes reusing scratch memory. */
+template<class Attribute0, class Attribute1>
+void SeparateToUnifiedIndices(
+		size_t numIndices,
+		const uint32_t indices0[],
+		const uint32_t indices1[],
+		size_t numAttributes0, const Attribute0 attributes0[],
+		size_t numAttributes1, const Attribute1 attributes1[],
+		std::vector<uint32_t>& outIndices,
+		std::vector<Attribute0>& outAttributes0,
+		std::vector<Attribute1>& outAttributes1,
+		UnifiedIndicesScratch& scratch);
+
 /// Convert seperate indices as found in OBJ files to unified ones
 /** This is an overloaded function. Variant for three attributes. */
 template<class Attribute0, class Attribute1, class Attribute2>
@@ -79,11 +180,257 @@ void SeparateToUnifiedIndices(
 		std::vector<Attribute1>& outAttributes1,
 		std::vector<Attribute2>& outAttributes2);
 
+/// Convert seperate indices as found in OBJ files to unified ones
+/** This is an overloaded function. Variant for three attributes reusing scratch memory. */
+template<class Attribute0, class Attribute1, class Attribute2>
+void SeparateToUnifiedIndices(
+		size_t numIndices,
+		const uint32_t indices0[],
+		const uint32_t indices1[],
+		const uint32_t indices2[],
+		size_t numAttributes0, const Attribute0 attributes0[],
+		size_t numAttributes1, const Attribute1 attributes1[],
+		size_t numAttributes2, const Attribute2 attributes2[],
+		std::vector<uint32_t>& outIndices,
+		std::vector<Attribute0>& outAttributes0,
+		std::vector<Attribute1>& outAttributes1,
+		std::vector<Attribute2>& outAttributes2,
+		UnifiedIndicesScratch& scratch);
+
+/// Unify separate index streams by sorting instead of hashing
+/** Backend of the SeparateToUnifiedIndices() variants taking a TaskDispatcher.
+	Each position gets a key combined from the indices of all streams. The
+	(key, position) pairs are radix sorted in parallel, and unique keys are
+	numbered in a parallel scan in order of their first occurrence. The result
+	is deterministic and identical to the hash based variants.
+
+	@param numStreams Number of index streams, at least one.
+	@param indices Array of numStreams pointers to arrays with numIndices elements each.
+	@param numAttributes Array of numStreams attribute counts. Indices must be less than these.
+	@param indexBase Added to each output index.
+	@param outIndices Unified indices are appended.
+	@param outFirstOccurrences Receives, for each unified vertex, the position where it
+		first occurs in the index streams.
+	@throw std::range_error if numIndices does not fit into 32 bits. */
+void UnifyIndicesBySorting(
+		TaskDispatcher& dispatcher,
+		size_t numIndices,
+		size_t numStreams,
+		const uint32_t* const indices[],
+		const size_t numAttributes[],
+		uint32_t indexBase,
+		std::vector<uint32_t>& outIndices,
+		std::vector<uint32_t>& outFirstOccurrences);
+
+/// Convert seperate indices as found in OBJ files to unified ones
+/** This is an overloaded function. Parallel variant for two attributes using
+	UnifyIndicesBySorting(). Scales with the number of cores, but needs more
+	temporary memory than the hash based variants. */
+template<class Attribute0, class Attribute1>
+void SeparateToUnifiedIndices(
+		TaskDispatcher& dispatcher,
+		size_t numIndices,
+		const uint32_t indices0[],
+		const uint32_t indices1[],
+		size_t numAttributes0, const Attribute0 attributes0[],
+		size_t numAttributes1, const Attribute1 attributes1[],
+		std::vector<uint32_t>& outIndices,
+		std::vector<Attribute0>& outAttributes0,
+		std::vector<Attribute1>& outAttributes1);
+
+/// Convert seperate indices as found in OBJ files to unified ones
+/** This is an overloaded function. Parallel variant for three attributes using
+	UnifyIndicesBySorting(). */
+template<class Attribute0, class Attribute1, class Attribute2>
+void SeparateToUnifiedIndices(
+		TaskDispatcher& dispatcher,
+		size_t numIndices,
+		const uint32_t indices0[],
+		const uint32_t indices1[],
+		const uint32_t indices2[],
+		size_t numAttributes0, const Attribute0 attributes0[],
+		size_t numAttributes1, const Attribute1 attributes1[],
+		size_t numAttributes2, const Attribute2 attributes2[],
+		std::vector<uint32_t>& outIndices,
+		std::vector<Attribute0>& outAttributes0,
+		std::vector<Attribute1>& outAttributes1,
+		std::vector<Attribute2>& outAttributes2);
+
+/// Average cache miss ratios reported by OptimizeVertexCache()
+struct VertexCacheStatistics
+{
+	/// Cache misses per triangle before optimization
+	float acmrBefore;
+
+	/// Cache misses per triangle after optimization
+	float acmrAfter;
+};
+
+/// Calculate the average cache miss ratio of a triangle list
+/** Simulates a FIFO post-transform vertex cache.
+	@returns Number of cache misses divided by the number of triangles. Values range
+		from 3 (no reuse) down to about 0.5 for regular grids. */
+float CalculateAcmr(const uint32_t indices[], size_t numIndices, unsigned int cacheSize = 16);
+
+/// Reorder triangles for post-transform vertex cache efficiency
+/** Implements Tipsify (Sander, Nehab and Barczak 2007), which runs in time linear
+	to the number of indices. The vertex order within triangles is preserved.
+	@param numVertices All indices must be less than this.
+	@param outIndices Array with numIndices elements. Must not alias indices. */
+void OptimizeVertexCache(const uint32_t indices[], size_t numIndices, size_t numVertices, uint32_t outIndices[], unsigned int cacheSize = 16);
+
+/// Reorder triangles of a mesh for post-transform vertex cache efficiency
+/** This is an overloaded function.
+	@throw std::runtime_error if the mesh does not consist of triangles. */
+VertexCacheStatistics OptimizeVertexCache(Mesh& mesh, unsigned int cacheSize = 16);
+
+/// Reorder triangles for vertex cache efficiency and reduced overdraw
+/** Implements the clustering of Sander, Nehab and Barczak (2007): The Tipsify
+	output is split into clusters, which are then sorted so that clusters facing
+	away from the mesh centroid come first. This tends to draw occluding
+	surfaces of closed meshes before occluded ones.
+	@param threshold Allowed ratio between the ACMR of a cluster and the ACMR of
+		the surrounding run of triangles. 1 gives few clusters and best cache
+		efficiency, higher values give more clusters and less overdraw.
+	@param outIndices Array with numIndices elements. Must not alias indices. */
+void OptimizeOverdraw(const uint32_t indices[], size_t numIndices, const Vector3 positions[], size_t numVertices, uint32_t outIndices[], float threshold = 1.05f, unsigned int cacheSize = 16);
+
+/// Reorder triangles of a mesh for vertex cache efficiency and reduced overdraw
+/** This is an overloaded function. Uses the VertexAttributeInfo::kPosition attribute.
+	@throw std::runtime_error if the mesh does not consist of triangles or has no positions. */
+VertexCacheStatistics OptimizeOverdraw(Mesh& mesh, float threshold = 1.05f, unsigned int cacheSize = 16);
+
+/// Reduce the number of triangles by quadric error edge collapse
+/** Edges are collapsed onto one of their vertices, so the result indexes the
+	original vertex buffers. Vertices sharing their position with other vertices,
+	as created by SeparateToUnifiedIndices() along attribute seams, and vertices
+	on open borders are never moved. Flat shaded meshes, where every triangle has
+	its own vertices, are therefore returned unchanged. Weld such meshes by
+	position before simplifying if the hard edges may be lost.
+	@param targetTriangleCount Stop when the triangle count reaches this value.
+	@param maxError Stop before exceeding this error, measured as distance in
+		position units.
+	@param outError If not nullptr, receives the error of the result.
+	@returns Triangle indices. */
+std::vector<uint32_t> Simplify(const uint32_t indices[], size_t numIndices, const Vector3 positions[], size_t numVertices, size_t targetTriangleCount, float maxError, float* outError = nullptr);
+
+/// Reduce the number of triangles of a mesh by quadric error edge collapse
+/** This is an overloaded function. Uses the VertexAttributeInfo::kPosition attribute.
+	@throw std::runtime_error if the mesh does not consist of triangles or has no positions. */
+std::vector<uint32_t> Simplify(const Mesh& mesh, size_t targetTriangleCount, float maxError, float* outError = nullptr);
+
+/// Generate index buffers for levels of detail sharing the vertex buffers of a mesh
+/** Each level is simplified from the previous one.
+	@param reduction Triangle count of each level relative to the previous one.
+	@returns Up to numLevels index buffers, starting with the original indices.
+		Fewer levels are returned if maxError prevents further simplification. */
+std::vector<std::vector<uint32_t>> SimplifyLodChain(const Mesh& mesh, size_t numLevels, float reduction = 0.5f, float maxError = std::numeric_limits<float>::max());
+
+/// Calculate a vertex order matching the first use by indices
+/** Vertices not referenced by any index are moved to the end, keeping their order.
+	@returns New position for each of the numVertices vertices. */
+std::vector<uint32_t> VertexFetchRemap(const uint32_t indices[], size_t numIndices, size_t numVertices);
+
+/// Reorder all vertex attributes and rewrite indices accordingly
+/** Works on raw attribute data, regardless of type and number of components.
+	@param remap New position for each vertex, as returned by VertexFetchRemap().
+	@throw std::runtime_error if remap is not a permutation of the vertices, an
+		index is out of range or an attribute size is not a multiple of the
+		vertex count. The mesh is left unchanged in this case. */
+void RemapVertices(Mesh& mesh, const std::vector<uint32_t>& remap);
+
+/// Reorder vertices for sequential memory access when traversing indices
+/** Call after OptimizeVertexCache(), which changes the order of indices. */
+void OptimizeVertexFetch(Mesh& mesh);
+
+/// Split a triangle list into meshlets for cluster culling
+/** Triangles are added to the current meshlet in index order until a limit is
+	reached, so indices should be optimized with OptimizeVertexCache() first to
+	get compact meshlets.
+	@param maxVertices Maximum vertices per meshlet, at most 256.
+	@param maxTriangles Maximum triangles per meshlet.
+	@throw std::range_error if maxVertices is out of range or maxTriangles is zero. */
+MeshletSet BuildMeshlets(const uint32_t indices[], size_t numIndices, const Vector3 positions[], size_t numVertices, size_t maxVertices = 64, size_t maxTriangles = 124);
+
+/// Split a triangle mesh into meshlets for cluster culling
+/** This is an overloaded function. Uses the VertexAttributeInfo::kPosition attribute.
+	@throw std::runtime_error if the mesh does not consist of triangles or has no positions. */
+MeshletSet BuildMeshlets(const Mesh& mesh, size_t maxVertices = 64, size_t maxTriangles = 124);
+
+/// Compress triangle indices
+/** Encodes triangles relative to recently seen edges and vertices, which works
+	best after OptimizeVertexCache() and OptimizeVertexFetch(). Typical meshes
+	need about one byte per triangle. Triangles may be rotated, keeping their
+	winding.
+	@throw std::range_error if numIndices is not a multiple of three or the
+		number of triangles does not fit into 32 bits. */
+std::vector<uint8_t> EncodeIndices(const uint32_t indices[], size_t numIndices);
+
+/// Decompress triangle indices encoded with EncodeIndices()
+/** @param outIndices Decoded indices are appended.
+	@throw std::runtime_error if the data is malformed. */
+void DecodeIndices(const void* data, size_t size, std::vector<uint32_t>& outIndices);
+
+/// Compress vertex data losslessly
+/** Each byte of the vertex is encoded separately as delta to the same byte of
+	the previous vertex. Deltas are stored in groups of 16 with the smallest
+	sufficient bit width of 0, 2, 4 or 8 bits. Smoothly varying data like
+	positions in optimized vertex order compresses best.
+	@param elementSize Bytes per vertex. size must be a multiple of it.
+	@throw std::range_error if size is not a multiple of elementSize, elementSize
+		is zero, or elementSize or the number of elements do not fit into 32 bits. */
+std::vector<uint8_t> EncodeVertexData(const void* data, size_t size, size_t elementSize);
+
+/// Compress attribute data losslessly
+/** This is an overloaded function. The element size is derived from the type and
+	number of components of the attribute. */
+std::vector<uint8_t> EncodeVertexData(const Mesh::Attribute& attribute);
+
+/// Decompress vertex data encoded with EncodeVertexData()
+/** Uses SSE2 where available.
+	@param outData Receives the raw vertex data.
+	@throw std::runtime_error if the data is malformed. */
+void DecodeVertexData(const void* data, size_t size, std::vector<uint8_t>& outData);
+
 /// Interleave vertex attribute data
 /** @param count Count of datums in data0 and data1. Size of data0 must be count times datumSize0 and size of data1 must be count times datumSize1.
 	@param outData Pointer to buffer that has the size of data0 and data1 combined. */
 void Interleave(size_t count, size_t datumSize0, size_t datumSize1, void* const data0, void* const data1, void* __restrict outData);
 
+/// Interleave an arbitrary number of vertex attribute streams
+/** Copies are specialized for the common element sizes of 4, 8, 12 and 16 bytes.
+	@param count Count of datums in each stream.
+	@param data Pointers to numStreams tightly packed streams.
+	@param datumSizes Size of a datum in bytes for each stream.
+	@param offsets Offset of each stream inside an interleaved vertex in bytes.
+	@param stride Size of an interleaved vertex in bytes.
+	@param outData Pointer to buffer with count times stride bytes. */
+void Interleave(size_t count, size_t numStreams, const void* const data[], const size_t datumSizes[], const size_t offsets[], size_t stride, void* __restrict outData);
+
+/// Vertex data of all attributes of a mesh in a single buffer
+struct InterleavedVertexData
+{
+	/// Interleaved vertex data of stride times number of vertices bytes
+	std::vector<uint8_t> data;
+
+	/// Layout of each attribute in data
+	/** The semantic member identifies the attribute, buffer is always 0. */
+	std::vector<VertexAttributeInfo> attributes;
+
+	/// Size of an interleaved vertex in bytes
+	size_t stride = 0;
+};
+
+/// Interleave all attributes of a mesh into a single vertex buffer
+/** Attributes are ordered by decreasing component size and then by name, so the
+	layout only depends on the set of attributes. Offsets and the stride are
+	aligned. Attributes are flagged as normalized according to
+	Mesh::Attribute::IsNormalized().
+	@param alignment Alignment of offsets and stride in bytes. Must be a power of two.
+	@throw std::range_error if alignment is not a power of two or an attribute
+		does not match the number of vertices. */
+InterleavedVertexData Interleave(const Mesh& mesh, size_t alignment = 4);
+
 /// Convert quad indices to triangle indices
 /** @param out Must have 3/2 times the size of in. */
 template<typename T>
@@ -93,6 +440,10 @@ void QuadToTriangleIndices(size_t quadCount, const T in[], T out[]);
 /** @see Transform() */
 void Scale(Mesh& mesh, float scaleFactor);
 
+/// Scale positions in place by a given factor
+/** This is an overloaded function. Works on interleaved buffers. */
+void Scale(StridedView<Vector3> positions, float scaleFactor);
+
 /// Calculate normal for triangle
 Vector3 TriangleNormal(const Vector3& p1, const Vector3& p2, const Vector3& p3);
 
@@ -100,6 +451,12 @@ Vector3 TriangleNormal(const Vector3& p1, const Vector3& p2, const Vector3& p3);
 /** @returns Normals for each vertex, NOT for each index! */
 std::vector<Vector3> IndexedTriangleNormals(const std::vector<Vector3>& positions, const int triangleIndices[], size_t triangleCount);
 
+/// Calculate normals for triangles defined by vertex positions and indices
+/** This is an overloaded function. Writes the normals to an existing, possibly
+	interleaved buffer.
+	@param outNormals Receives normals for each vertex. Must be as large as positions. */
+void IndexedTriangleNormals(StridedView<const Vector3> positions, const int triangleIndices[], size_t triangleCount, StridedView<Vector3> outNormals);
+
 /// Calculate neighbouring triangles
 /** @returns Indices to triangle neighbours, in the order "triangle 0 neighbor 0, triangle 0
 		neighbor 1, triangle 0 neighbor 2, triangle 1 neighbor 0, ...". This means it has 3x
@@ -112,10 +469,18 @@ std::vector<int> TriangleNeighbours(const int triangleIndices[], unsigned int tr
 	@todo Handle more attribute types properly. */
 void Transform(Mesh& mesh, const Matrix4& transform);
 
+/// Transform positions and normals in place by a matrix
+/** This is an overloaded function. Works on interleaved buffers.
+	@param positions Positions to transform, may be empty.
+	@param normals Normals to transform as directions, may be empty. */
+void Transform(StridedView<Vector3> positions, StridedView<Vector3> normals, const Matrix4& transform);
+
 /// Use half floats or integer types where appropriate
-/** @param mesh Mesh to process
+/** Attributes that are not of the expected type are left unchanged.
+	@param mesh Mesh to process
 	@param toHalf Vertex buffers to reduce from 32 bit to 16 bit floats
 	@param toInt8 Vertex buffers to reduce from 32 bit to 8 bit integers
+	@see ReducePrecision(Mesh&, const std::unordered_map<Hash, Quantization>&)
 */
 void ReducePrecision(Mesh& mesh,
 	const std::unordered_set<Hash>& toHalf = {
@@ -130,8 +495,60 @@ void ReducePrecision(Mesh& mesh,
 	}
 );
 
+/// Attribute conversions for ReducePrecision()
+enum class Quantization
+{
+	/// 32 bit floats to 16 bit floats
+	kHalf,
+
+	/// 32 bit integers to 8 bit integers
+	kInt8,
+
+	/// Unit vectors to two 8 bit signed normalized octahedral coordinates
+	/** Four component vectors like tangents keep the sign of the fourth component
+		as a third coordinate. */
+	kOctahedral8,
+
+	/// Unit vectors to two 16 bit signed normalized octahedral coordinates
+	/** @see kOctahedral8 */
+	kOctahedral16,
+
+	/// Positions to 16 bit unsigned normalized values relative to the bounding box
+	kBoxUNorm16
+};
+
+/// Map a unit vector to octahedral coordinates in [-1, 1]
+Vector2 OctahedralEncode(const Vector3& v);
+
+/// Map octahedral coordinates in [-1, 1] back to a unit vector
+Vector3 OctahedralDecode(const Vector2& e);
+
+/// Convert attributes to compact representations
+/** Quantization::kInt8 requires 32 bit integer attributes, all other modes
+	float attributes. Octahedral encoding requires three or four components,
+	kBoxUNorm16 three components. At most one attribute can use kBoxUNorm16.
+	All attributes are checked before any is converted. Octahedral and box
+	quantized attributes are flagged as normalized, see Mesh::Attribute::IsNormalized().
+	@param modes Conversion for each attribute to convert. Attributes missing in
+		the mesh are ignored.
+	@returns Transformation from normalized coordinates to the original positions
+		for attributes quantized with Quantization::kBoxUNorm16, identity otherwise.
+	@throw std::runtime_error if an attribute cannot be quantized with the
+		requested mode. The mesh is left unchanged in this case. */
+Matrix4 ReducePrecision(Mesh& mesh, const std::unordered_map<Hash, Quantization>& modes);
+
 /*****************************************************************************/
 
+/// Reserve space for count more elements
+/** Grows the capacity geometrically, so that appending in many calls stays linear. */
+template<typename T>
+void ReserveAdditional(std::vector<T>& vector, size_t count)
+{
+	const size_t size = vector.size() + count;
+	if(size > vector.capacity())
+		vector.reserve(std::max(size, vector.capacity() * 2));
+}
+
 template<class Attribute0, class Attribute1>
 void SeparateToUnifiedIndices(
 		size_t numIndices,
@@ -142,10 +559,38 @@ void SeparateToUnifiedIndices(
 		std::vector<uint32_t>& outIndices,
 		std::vector<Attribute0>& outAttributes0,
 		std::vector<Attribute1>& outAttributes1)
+{
+	UnifiedIndicesScratch scratch;
+	SeparateToUnifiedIndices(
+			numIndices,
+			indices0,
+			indices1,
+			numAttributes0, attributes0,
+			numAttributes1, attributes1,
+			outIndices,
+			outAttributes0,
+			outAttributes1,
+			scratch);
+}
+
+template<class Attribute0, class Attribute1>
+void SeparateToUnifiedIndices(
+		size_t numIndices,
+		const uint32_t indices0[],
+		const uint32_t indices1[],
+		size_t numAttributes0, const Attribute0 attributes0[],
+		size_t numAttributes1, const Attribute1 attributes1[],
+		std::vector<uint32_t>& outIndices,
+		std::vector<Attribute0>& outAttributes0,
+		std::vector<Attribute1>& outAttributes1,
+		UnifiedIndicesScratch& scratch)
 {
 	if(indices0 && indices1)
 	{
-		std::unordered_map<uint64_t, uint32_t> vertexMap;
+		auto& vertexMap = scratch.vertexMap;
+		vertexMap.Clear();
+		vertexMap.Reserve(numIndices / 4); // Typical triangle meshes have fewer unique vertices, the map grows otherwise
+		ReserveAdditional(outIndices, numIndices);
 
 		for(size_t i = 0; i < numIndices; ++i)
 		{
@@ -153,22 +598,16 @@ void SeparateToUnifiedIndices(
 			uint32_t index1 = indices1[i];
 
 			const uint64_t combinedIndex = (static_cast<uint64_t>(index0) << 32) | index1;
-			auto it = vertexMap.find(combinedIndex);
-
-			if(it == vertexMap.end())
+			auto result = vertexMap.Insert(combinedIndex, uint32_t(outAttributes0.size()));
+			if(result.second)
 			{
-				uint32_t outIndex = outAttributes0.size();
-				vertexMap[combinedIndex] = outIndex;
-				outIndices.push_back(outIndex);
-
 				assert(numAttributes0 > index0);
 				outAttributes0.push_back(attributes0[index0]);
 
 				assert(numAttributes1 > index1);
 				outAttributes1.push_back(attributes1[index1]);
 			}
-			else
-				outIndices.push_back(it->second);
+			outIndices.push_back(*result.first);
 		}
 	}
 	else if(indices0)
@@ -196,6 +635,37 @@ void SeparateToUnifiedIndices(
 		std::vector<Attribute0>& outAttributes0,
 		std::vector<Attribute1>& outAttributes1,
 		std::vector<Attribute2>& outAttributes2)
+{
+	UnifiedIndicesScratch scratch;
+	SeparateToUnifiedIndices(
+			numIndices,
+			indices0,
+			indices1,
+			indices2,
+			numAttributes0, attributes0,
+			numAttributes1, attributes1,
+			numAttributes2, attributes2,
+			outIndices,
+			outAttributes0,
+			outAttributes1,
+			outAttributes2,
+			scratch);
+}
+
+template<class Attribute0, class Attribute1, class Attribute2>
+void SeparateToUnifiedIndices(
+		size_t numIndices,
+		const uint32_t indices0[],
+		const uint32_t indices1[],
+		const uint32_t indices2[],
+		size_t numAttributes0, const Attribute0 attributes0[],
+		size_t numAttributes1, const Attribute1 attributes1[],
+		size_t numAttributes2, const Attribute2 attributes2[],
+		std::vector<uint32_t>& outIndices,
+		std::vector<Attribute0>& outAttributes0,
+		std::vector<Attribute1>& outAttributes1,
+		std::vector<Attribute2>& outAttributes2,
+		UnifiedIndicesScratch& scratch)
 {
 	if(indices0 && indices1 && indices2)
 	{
@@ -229,15 +699,18 @@ void SeparateToUnifiedIndices(
 					outIndices,
 					outAttributes01,
 					outAttributes2);
-		outAttributes0.reserve(outAttributes01.size());
-		outAttributes1.reserve(outAttributes01.size());
+		ReserveAdditional(outAttributes0, outAttributes01.size());
+		ReserveAdditional(outAttributes1, outAttributes01.size());
 		for(auto attr: outAttributes01)
 		{
 			outAttributes0.push_back(attr.first);
 			outAttributes1.push_back(attr.second);
 		}
 #else
-		std::unordered_map<uint64_t, uint32_t> vertexMap;
+		auto& vertexMap = scratch.tripleVertexMap;
+		vertexMap.Clear();
+		vertexMap.Reserve(numIndices / 4); // Typical triangle meshes have fewer unique vertices, the map grows otherwise
+		ReserveAdditional(outIndices, numIndices);
 
 		for(size_t i = 0; i < numIndices; ++i)
 		{
@@ -245,15 +718,9 @@ void SeparateToUnifiedIndices(
 			uint32_t index1 = indices1[i];
 			uint32_t index2 = indices2[i];
 
-			// Use 64 bits equally for three indices, 21 bits. Therefore this supports up to 2.1 million vertices:
-			const uint64_t combinedIndex = (static_cast<uint64_t>(index2) << 42) | (static_cast<uint64_t>(index1) << 21) | index0;
-			auto it = vertexMap.find(combinedIndex);
-
-			if(it == vertexMap.end())
+			auto result = vertexMap.Insert(IndexTriple{index0, index1, index2}, uint32_t(outAttributes0.size()));
+			if(result.second)
 			{
-				uint32_t outIndex = outAttributes0.size();
-				vertexMap[combinedIndex] = outIndex;
-				outIndices.push_back(outIndex);
 				assert(numAttributes0 > index0);
 				outAttributes0.push_back(attributes0[index0]);
 
@@ -263,8 +730,7 @@ void SeparateToUnifiedIndices(
 				assert(numAttributes2 > index2);
 				outAttributes2.push_back(attributes2[index2]);
 			}
-			else
-				outIndices.push_back(it->second);
+			outIndices.push_back(*result.first);
 		}
 #endif
 	}
@@ -278,7 +744,8 @@ void SeparateToUnifiedIndices(
 				numAttributes2, attributes2,
 				outIndices,
 				outAttributes1,
-				outAttributes2);
+				outAttributes2,
+				scratch);
 	}
 	else if(!indices1)
 	{
@@ -290,7 +757,8 @@ void SeparateToUnifiedIndices(
 				numAttributes2, attributes2,
 				outIndices,
 				outAttributes0,
-				outAttributes2);
+				outAttributes2,
+				scratch);
 	}
 	else if(!indices2)
 	{
@@ -302,10 +770,121 @@ void SeparateToUnifiedIndices(
 				numAttributes1, attributes1,
 				outIndices,
 				outAttributes0,
-				outAttributes1);
+				outAttributes1,
+				scratch);
 	}
 }
 
+template<class Attribute0, class Attribute1>
+void SeparateToUnifiedIndices(
+		TaskDispatcher& dispatcher,
+		size_t numIndices,
+		const uint32_t indices0[],
+		const uint32_t indices1[],
+		size_t numAttributes0, const Attribute0 attributes0[],
+		size_t numAttributes1, const Attribute1 attributes1[],
+		std::vector<uint32_t>& outIndices,
+		std::vector<Attribute0>& outAttributes0,
+		std::vector<Attribute1>& outAttributes1)
+{
+	if(!indices0 || !indices1)
+	{
+		// Nothing to unify, indices are copied:
+		UnifiedIndicesScratch scratch;
+		SeparateToUnifiedIndices(numIndices, indices0, indices1,
+				numAttributes0, attributes0, numAttributes1, attributes1,
+				outIndices, outAttributes0, outAttributes1, scratch);
+		return;
+	}
+
+	const uint32_t* const indices[] = {indices0, indices1};
+	const size_t numAttributes[] = {numAttributes0, numAttributes1};
+	std::vector<uint32_t> firstOccurrences;
+	const size_t base = outAttributes0.size();
+	UnifyIndicesBySorting(dispatcher, numIndices, 2, indices, numAttributes, uint32_t(base), outIndices, firstOccurrences);
+
+	const size_t count = firstOccurrences.size();
+	outAttributes0.resize(base + count);
+	outAttributes1.resize(outAttributes1.size() + count);
+	Attribute0* out0 = outAttributes0.data() + base;
+	Attribute1* out1 = outAttributes1.data() + outAttributes1.size() - count;
+	const size_t kBlockSize = 1 << 16;
+	ParallelFor(dispatcher, (count + kBlockSize - 1) / kBlockSize, [&](size_t block)
+	{
+		const size_t end = std::min(count, (block + 1) * kBlockSize);
+		for(size_t i = block * kBlockSize; i < end; ++i)
+		{
+			const uint32_t position = firstOccurrences[i];
+			out0[i] = attributes0[indices0[position]];
+			out1[i] = attributes1[indices1[position]];
+		}
+	});
+}
+
+template<class Attribute0, class Attribute1, class Attribute2>
+void SeparateToUnifiedIndices(
+		TaskDispatcher& dispatcher,
+		size_t numIndices,
+		const uint32_t indices0[],
+		const uint32_t indices1[],
+		const uint32_t indices2[],
+		size_t numAttributes0, const Attribute0 attributes0[],
+		size_t numAttributes1, const Attribute1 attributes1[],
+		size_t numAttributes2, const Attribute2 attributes2[],
+		std::vector<uint32_t>& outIndices,
+		std::vector<Attribute0>& outAttributes0,
+		std::vector<Attribute1>& outAttributes1,
+		std::vector<Attribute2>& outAttributes2)
+{
+	if(!indices0)
+	{
+		SeparateToUnifiedIndices(dispatcher, numIndices, indices1, indices2,
+				numAttributes1, attributes1, numAttributes2, attributes2,
+				outIndices, outAttributes1, outAttributes2);
+		return;
+	}
+	else if(!indices1)
+	{
+		SeparateToUnifiedIndices(dispatcher, numIndices, indices0, indices2,
+				numAttributes0, attributes0, numAttributes2, attributes2,
+				outIndices, outAttributes0, outAttributes2);
+		return;
+	}
+	else if(!indices2)
+	{
+		SeparateToUnifiedIndices(dispatcher, numIndices, indices0, indices1,
+				numAttributes0, attributes0, numAttributes1, attributes1,
+				outIndices, outAttributes0, outAttributes1);
+		return;
+	}
+
+	const uint32_t* const indices[] = {indices0, indices1, indices2};
+	const size_t numAttributes[] = {numAttributes0, numAttributes1, numAttributes2};
+	std::vector<uint32_t> firstOccurrences;
+	const size_t base = outAttributes0.size();
+	UnifyIndicesBySorting(dispatcher, numIndices, 3, indices, numAttributes, uint32_t(base), outIndices, firstOccurrences);
+
+	const size_t count = firstOccurrences.size();
+	outAttributes0.resize(base + count);
+	outAttributes1.resize(outAttributes1.size() + count);
+	outAttributes2.resize(outAttributes2.size() + count);
+	Attribute0* out0 = outAttributes0.data() + base;
+	Attribute1* out1 = outAttributes1.data() + outAttributes1.size() - count;
+	Attribute2* out2 = outAttributes2.data() + outAttributes2.size() - count;
+	const size_t kBlockSize = 1 << 16;
+	ParallelFor(dispatcher, (count + kBlockSize - 1) / kBlockSize, [&](size_t block)
+	{
+		const size_t end = std::min(count, (block + 1) * kBlockSize);
+		for(size_t i = block * kBlockSize; i < end; ++i)
+		{
+			const uint32_t position = firstOccurrences[i];
+			out0[i] = attributes0[indices0[position]];
+			out1[i] = attributes1[indices1[position]];
+			out2[i] = attributes2[indices2[position]];
+		}
+	});
+}
+
 }
 }
 } // namespace molecular
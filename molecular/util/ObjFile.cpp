@@ -24,217 +24,1061 @@ SOFTWARE.
 */
 
 #include "ObjFile.h"
-#include <molecular/util/StringUtils.h>
+#include <molecular/util/ObjTokenizer.h>
+#include <molecular/util/ParallelFor.h>
+#include <molecular/util/FileStreamStorage.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
 #include <cstring>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <type_traits>
 
 namespace molecular
 {
 namespace util
 {
 
-ObjFile::ObjFile(TextReadStreamBase& stream, float scale) :
-	mScale(scale)
+namespace
 {
-	const char* line;
-	std::string currentMaterial;
-	bool newMaterial = false;
-	while((line = stream.GetNextLine()))
+
+/// Text is split into chunks of roughly this size for parallel parsing
+const size_t kChunkSize = 1 << 20;
+
+/// Faces or vertices per task in CalculateNormals()
+const size_t kNormalTaskSize = 1 << 16;
+
+/// Faces processed together as structure of arrays in CalculateNormals()
+const size_t kNormalBatchSize = 64;
+
+/// Computes vertex normals for ObjFileT::CalculateNormals()
+/** Face normals are computed in batches of structure-of-arrays data, which
+	compilers turn into SIMD code. They are then gathered per vertex through
+	a vertex-to-corner adjacency list, so ranges of vertices can be processed
+	concurrently without write conflicts, and the summation order does not
+	depend on the number of threads. Corners are numbered all triangles first,
+	then all quads. */
+template<class TTriangle, class TQuad>
+class NormalCalculator
+{
+public:
+	NormalCalculator(const std::vector<Vector3>& vertices, const std::vector<TTriangle>& triangles, const std::vector<TQuad>& quads, ObjNormalWeighting weighting) :
+		mVertices(vertices),
+		mTriangles(triangles),
+		mQuads(quads),
+		mWeighting(weighting),
+		mFaceNormals(triangles.size() + quads.size()),
+		mNumTriangleCorners(triangles.size() * 3)
 	{
-		if(line[0] == 0 || line[0] == '#')
-			continue; // Skip empty lines and comments
+		const size_t numCorners = mNumTriangleCorners + quads.size() * 4;
+		if(numCorners > std::numeric_limits<uint32_t>::max())
+			throw std::range_error("ObjFile: Too many faces for normal calculation");
+		if(weighting == ObjNormalWeighting::kAngle)
+			mCornerWeights.resize(numCorners);
+	}
+
+	size_t GetNumFaceTasks() const {return (mFaceNormals.size() + kNormalTaskSize - 1) / kNormalTaskSize;}
+	size_t GetNumVertexTasks() const {return (mVertices.size() + kNormalTaskSize - 1) / kNormalTaskSize;}
 
-		if(line[0] == 'v')
+	/// Compute normals (and angles) of a range of faces
+	void ComputeFaceNormals(size_t task)
+	{
+		const size_t begin = task * kNormalTaskSize;
+		const size_t end = std::min(begin + kNormalTaskSize, mFaceNormals.size());
+		const size_t numTriangles = mTriangles.size();
+
+		// Triangles part of the range:
+		if(begin < numTriangles)
 		{
-			if(line[1] == ' ')
-			{
-				Vector3 v;
-				int result = StringUtils::ScanF(line, "v %f %f %f", &v[0], &v[1], &v[2]);
-				if(result != 3)
-					continue;
-				v *= mScale;
-				mVertices.push_back(v);
-				mBoundingBox.Stretch(v);
-			}
-			else if(line[1] == 't')
-			{
-				float u, v;
-				int result = StringUtils::ScanF(line, "vt %f %f", &u, &v);
-				if(result != 2)
-					continue;
-				mTexCoords.push_back(Vector2(u, 1 - v));
-			}
-			else if(line[1] == 'n')
-			{
-				float x, y, z;
-				int result = StringUtils::ScanF(line, "vn %f %f %f", &x, &y, &z);
-				if(result != 3)
-					continue;
-				mNormals.push_back(Vector3(x, y, z));
-			}
+			const size_t triangleEnd = std::min(end, numTriangles);
+			FaceNormals<3>(mTriangles.data() + begin, triangleEnd - begin, mFaceNormals.data() + begin);
+			if(!mCornerWeights.empty())
+				CornerAngles<3>(mTriangles.data() + begin, triangleEnd - begin, mCornerWeights.data() + begin * 3);
 		}
-		else if(line[0] == 'g')
+
+		// Quads part of the range:
+		if(end > numTriangles)
 		{
-			NewVertexGroup(line + 2, currentMaterial);
-			newMaterial = false;
+			const size_t quadBegin = std::max(begin, numTriangles) - numTriangles;
+			const size_t quadEnd = end - numTriangles;
+			FaceNormals<4>(mQuads.data() + quadBegin, quadEnd - quadBegin, mFaceNormals.data() + numTriangles + quadBegin);
+			if(!mCornerWeights.empty())
+				CornerAngles<4>(mQuads.data() + quadBegin, quadEnd - quadBegin, mCornerWeights.data() + mNumTriangleCorners + quadBegin * 4);
 		}
-		else if(line[0] == 'f')
+	}
+
+	/// Sort corners by vertex
+	void BuildAdjacency()
+	{
+		mVertexCornersBegin.assign(mVertices.size() + 1, 0);
+		ForEachCorner([this](uint32_t, size_t vertex){mVertexCornersBegin[vertex + 1]++;});
+		for(size_t i = 1; i < mVertexCornersBegin.size(); ++i)
+			mVertexCornersBegin[i] += mVertexCornersBegin[i - 1];
+
+		mVertexCorners.resize(mVertexCornersBegin.back());
+		std::vector<uint32_t> cursor(mVertexCornersBegin.begin(), mVertexCornersBegin.end() - 1);
+		ForEachCorner([&](uint32_t corner, size_t vertex){mVertexCorners[cursor[vertex]++] = corner;});
+	}
+
+	/// Sum up and normalize face normals for a range of vertices
+	void GatherVertexNormals(size_t task, Vector3* outNormals) const
+	{
+		const size_t begin = task * kNormalTaskSize;
+		const size_t end = std::min(begin + kNormalTaskSize, mVertices.size());
+		for(size_t vertex = begin; vertex < end; ++vertex)
 		{
-			/* Blender changes materials without creating vertex groups, so
-				create vertex group if material changed: */
-			if(newMaterial)
+			float sum[3] = {0, 0, 0};
+			for(uint32_t i = mVertexCornersBegin[vertex]; i < mVertexCornersBegin[vertex + 1]; ++i)
 			{
-				NewVertexGroup(currentMaterial, currentMaterial);
-				newMaterial = false;
+				const uint32_t corner = mVertexCorners[i];
+				const size_t face = (corner < mNumTriangleCorners)
+						? corner / 3
+						: mTriangles.size() + (corner - mNumTriangleCorners) / 4;
+				const float weight = mCornerWeights.empty() ? 1.0f : mCornerWeights[corner];
+				for(int j = 0; j < 3; ++j)
+					sum[j] += mFaceNormals[face][j] * weight;
 			}
+			const float length = std::sqrt(sum[0] * sum[0] + sum[1] * sum[1] + sum[2] * sum[2]);
+			const float scale = (length > 0) ? 1.0f / length : 0.0f;
+			outNormals[vertex] = Vector3(sum[0] * scale, sum[1] * scale, sum[2] * scale);
+		}
+	}
 
-			if(mVertexGroups.empty())
-				throw std::runtime_error("Face definition without vertex group");
+private:
+	/// Call function(corner, vertex) for all face corners in order
+	template<class TFunction>
+	void ForEachCorner(TFunction function) const
+	{
+		uint32_t corner = 0;
+		for(auto& triangle: mTriangles)
+		{
+			for(auto vertex: triangle.vertexIndices)
+				function(corner++, vertex);
+		}
+		for(auto& quad: mQuads)
+		{
+			for(auto vertex: quad.vertexIndices)
+				function(corner++, vertex);
+		}
+	}
 
-			int v[4] = {0, 0, 0, 0};
-			int t[4] = {0, 0, 0, 0};
-			int n[4] = {0, 0, 0, 0};
+	/// Cross products of two face edges, normalized unless weighted by area
+	/** Triangles use two edges, quads use the diagonals. Both yield twice
+		the area as length. */
+	template<int vertices, class TFace>
+	void FaceNormals(const TFace* faces, size_t count, Vector3* outNormals) const
+	{
+		// Vertices making up the edges a = p1 - p0 and b = p3 - p2:
+		const int kEdges[2][4] = {{0, 1, 0, 2}, {0, 2, 1, 3}};
+		const int* edges = kEdges[vertices - 3];
+		const bool normalize = (mWeighting != ObjNormalWeighting::kArea);
 
-			bool isTri = false;
-			bool isQuad = false;
-			// Positions and texCoords:
-			int result = StringUtils::ScanF(line, "f %d/%d %d/%d %d/%d %d/%d", &v[0], &t[0], &v[1], &t[1], &v[2], &t[2], &v[3], &t[3]);
-			if(result == 6 || result == 8)
-			{
-				isTri = (result == 6);
-				isQuad = (result == 8);
-				mVertexGroups.back().hasNormals = false;
-				mVertexGroups.back().hasTexCoords = true;
-			}
-			else
+		float a[3][kNormalBatchSize], b[3][kNormalBatchSize];
+		for(size_t batch = 0; batch < count; batch += kNormalBatchSize)
+		{
+			const size_t n = std::min(kNormalBatchSize, count - batch);
+			for(size_t i = 0; i < n; ++i)
 			{
-				// Positions, texCoords and normals:
-				result = StringUtils::ScanF(line, "f %d/%d/%d %d/%d/%d %d/%d/%d %d/%d/%d", &v[0], &t[0], &n[0], &v[1], &t[1], &n[1], &v[2], &t[2], &n[2], &v[3], &t[3], &n[3]);
-				if(result == 9 || result == 12)
+				const auto& indices = faces[batch + i].vertexIndices;
+				const Vector3& p0 = mVertices[indices[edges[0]]];
+				const Vector3& p1 = mVertices[indices[edges[1]]];
+				const Vector3& p2 = mVertices[indices[edges[2]]];
+				const Vector3& p3 = mVertices[indices[edges[3]]];
+				for(int j = 0; j < 3; ++j)
 				{
-					isTri = (result == 9);
-					isQuad = (result == 12);
-					mVertexGroups.back().hasNormals = true;
-					mVertexGroups.back().hasTexCoords = true;
+					a[j][i] = p1[j] - p0[j];
+					b[j][i] = p3[j] - p2[j];
 				}
-				else
+			}
+
+			float normal[3][kNormalBatchSize];
+			for(size_t i = 0; i < n; ++i)
+			{
+				const float x = a[1][i] * b[2][i] - a[2][i] * b[1][i];
+				const float y = a[2][i] * b[0][i] - a[0][i] * b[2][i];
+				const float z = a[0][i] * b[1][i] - a[1][i] * b[0][i];
+				const float lengthSquared = x * x + y * y + z * z;
+				const float scale = (!normalize) ? 1.0f : (lengthSquared > 0) ? 1.0f / std::sqrt(lengthSquared) : 0.0f;
+				normal[0][i] = x * scale;
+				normal[1][i] = y * scale;
+				normal[2][i] = z * scale;
+			}
+
+			for(size_t i = 0; i < n; ++i)
+				outNormals[batch + i] = Vector3(normal[0][i], normal[1][i], normal[2][i]);
+		}
+	}
+
+	/// Interior angles at each corner of the faces
+	template<int vertices, class TFace>
+	void CornerAngles(const TFace* faces, size_t count, float* outAngles) const
+	{
+		float a[3][kNormalBatchSize], b[3][kNormalBatchSize];
+		for(size_t batch = 0; batch < count; batch += kNormalBatchSize)
+		{
+			const size_t n = std::min(kNormalBatchSize, count - batch);
+			for(int corner = 0; corner < vertices; ++corner)
+			{
+				for(size_t i = 0; i < n; ++i)
 				{
-					// Positions and normals:
-					result = StringUtils::ScanF(line, "f %d//%d %d//%d %d//%d %d//%d", &v[0], &n[0], &v[1], &n[1], &v[2], &n[2], &v[3], &n[3]);
-					if(result == 6 || result == 8)
-					{
-						isTri = (result == 6);
-						isQuad = (result == 8);
-						mVertexGroups.back().hasNormals = true;
-						mVertexGroups.back().hasTexCoords = false;
-					}
-					else
+					const auto& indices = faces[batch + i].vertexIndices;
+					const Vector3& p = mVertices[indices[corner]];
+					const Vector3& next = mVertices[indices[(corner + 1) % vertices]];
+					const Vector3& previous = mVertices[indices[(corner + vertices - 1) % vertices]];
+					for(int j = 0; j < 3; ++j)
 					{
-						// Only positions:
-						result = StringUtils::ScanF(line, "f %d %d %d %d", &v[0], &v[1], &v[2], &v[3]);
-						if(result == 3)
-							isTri = true;
-						else if(result == 4)
-							isQuad = true;
-						mVertexGroups.back().hasNormals = false;
-						mVertexGroups.back().hasTexCoords = false;
+						a[j][i] = next[j] - p[j];
+						b[j][i] = previous[j] - p[j];
 					}
 				}
+
+				for(size_t i = 0; i < n; ++i)
+				{
+					const float dot = a[0][i] * b[0][i] + a[1][i] * b[1][i] + a[2][i] * b[2][i];
+					const float lengths = std::sqrt((a[0][i] * a[0][i] + a[1][i] * a[1][i] + a[2][i] * a[2][i])
+							* (b[0][i] * b[0][i] + b[1][i] * b[1][i] + b[2][i] * b[2][i]));
+					const float cosine = (lengths > 0) ? std::clamp(dot / lengths, -1.0f, 1.0f) : 1.0f;
+					outAngles[(batch + i) * vertices + corner] = std::acos(cosine);
+				}
 			}
+		}
+	}
 
-			// Indices count from 1!
-			if(v[0] > mVertices.size() || v[1] > mVertices.size() || v[2] > mVertices.size())
-				throw std::runtime_error("ObjFile: Non-existent vertex referenced.");
+	const std::vector<Vector3>& mVertices;
+	const std::vector<TTriangle>& mTriangles;
+	const std::vector<TQuad>& mQuads;
+	ObjNormalWeighting mWeighting;
 
-			if(isTri)
-			{
-				mTriangles.push_back(Triangle(v, t, n));
-				mVertexGroups.back().numTriangles++;
-			}
-			else if(isQuad)
-			{
-				if(v[3] > mVertices.size())
-					throw std::runtime_error("ObjFile: Non-existent vertex referenced.");
+	std::vector<Vector3> mFaceNormals;
+	std::vector<float> mCornerWeights;
+	const size_t mNumTriangleCorners;
 
-				mQuads.push_back(Quad(v, t, n));
-				mVertexGroups.back().numQuads++;
-			}
+	std::vector<uint32_t> mVertexCornersBegin;
+	std::vector<uint32_t> mVertexCorners;
+};
+
+/// Start of a file written by ObjFileT::WriteCache()
+/** Followed by the arrays of vertices, texture coordinates, normals, quads,
+	triangles, CacheVertexGroup and CacheString (for material libraries) in
+	this order, each padded to four bytes, and finally the string characters. */
+struct CacheHeader
+{
+	static const char kMagic[8];
+	static const uint32_t kVersion = 2;
+
+	char magic[8];
+	uint32_t version;
+	uint32_t indexSize;
+	float scale;
+	uint32_t polygonMode;
+	uint32_t numVertexGroups;
+	uint32_t numMtlLibFiles;
+	uint32_t stringBytes;
+	Hash sourceHash;
+	uint64_t sourceSize;
+	uint64_t numVertices;
+	uint64_t numTexCoords;
+	uint64_t numNormals;
+	uint64_t numQuads;
+	uint64_t numTriangles;
+	float boundingBox[6];
+};
+
+const char CacheHeader::kMagic[8] = {'M', 'O', 'B', 'J', 'C', 'A', 'C', 'H'};
+
+/// Reference into the string characters
+struct CacheString
+{
+	uint32_t offset;
+	uint32_t length;
+};
+
+struct CacheVertexGroup
+{
+	CacheString name;
+	CacheString material;
+	uint32_t firstQuad;
+	uint32_t numQuads;
+	uint32_t firstTriangle;
+	uint32_t numTriangles;
+	uint32_t hasNormals;
+	uint32_t hasTexCoords;
+};
+
+/// Unique file name in the same directory as path
+/** Same directory, so that the file can be renamed to path. */
+std::string TemporaryPath(const std::string& path)
+{
+	static std::atomic<unsigned int> counter(0);
+	std::random_device random;
+	char suffix[32];
+	std::snprintf(suffix, sizeof(suffix), ".%08x%08x.%u.tmp", random(), random(), counter++);
+	return path + suffix;
+}
+
+size_t PaddedSize(size_t size)
+{
+	return (size + 3) & ~size_t(3);
+}
+
+template<typename T>
+void WriteArray(WriteStorage& storage, const T* data, size_t count)
+{
+	static_assert(std::is_trivially_copyable<T>::value, "Cache arrays must be trivially copyable");
+	static const uint8_t kPadding[4] = {0, 0, 0, 0};
+	const size_t size = count * sizeof(T);
+	if(size)
+		storage.Write(data, size);
+	storage.Write(kPadding, PaddedSize(size) - size);
+}
+
+/// Copies arrays out of cache data, checking bounds
+class CacheReader
+{
+public:
+	CacheReader(const void* data, size_t size) :
+		mBytes(static_cast<const uint8_t*>(data)),
+		mSize(size)
+	{}
+
+	template<typename T>
+	bool ReadArray(std::vector<T>& out, uint64_t count)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "Cache arrays must be trivially copyable");
+		if(count > (mSize - mOffset) / sizeof(T))
+			return false;
+		const size_t size = size_t(count) * sizeof(T);
+		out.resize(size_t(count));
+		if(size)
+			std::memcpy(out.data(), mBytes + mOffset, size);
+		mOffset = std::min(mSize, mOffset + PaddedSize(size));
+		return true;
+	}
+
+	/// Remaining data after all arrays
+	std::string_view GetRemainder() const
+	{
+		return std::string_view(reinterpret_cast<const char*>(mBytes) + mOffset, mSize - mOffset);
+	}
+
+private:
+	const uint8_t* mBytes;
+	size_t mSize;
+	size_t mOffset = sizeof(CacheHeader);
+};
+
+}
+
+/// Receives tokens from ObjTokenizer and fills in the data
+template<typename TIndex>
+class ObjFileT<TIndex>::Reader
+{
+public:
+	using FaceVertex = ObjTokenizer::FaceVertex;
+	using FaceFormat = ObjTokenizer::FaceFormat;
+
+	explicit Reader(ObjFileT& file) : mFile(file) {}
+
+	void Vertex(Vector3 v)
+	{
+		v *= mFile.mScale;
+		mFile.mVertices.push_back(v);
+		mFile.mBoundingBox.Stretch(v);
+	}
+
+	void TexCoord(const Vector2& uv)
+	{
+		mFile.mTexCoords.push_back(Vector2(uv[0], 1 - uv[1]));
+	}
+
+	void Normal(const Vector3& n)
+	{
+		mFile.mNormals.push_back(n);
+	}
+
+	void Group(std::string_view name)
+	{
+		mFile.NewVertexGroup(std::string(name), mCurrentMaterial);
+		mNewMaterial = false;
+	}
+
+	void Object(std::string_view name)
+	{
+		mFile.NewVertexGroup(std::string(name), "");
+	}
+
+	void UseMaterial(std::string_view material)
+	{
+		if(!mFile.mVertexGroups.empty() && mFile.mVertexGroups.back().material.empty())
+			mFile.mVertexGroups.back().material = material;
+		else
+		{
+			mCurrentMaterial = material;
+			mNewMaterial = true;
 		}
-		else if(!strncmp(line, "usemtl", 6))
+	}
+
+	void MaterialLibrary(std::string_view file)
+	{
+		mFile.mMtlLibFiles.push_back(std::string(file));
+	}
+
+	void Face(const FaceVertex vertices[], size_t count, FaceFormat format)
+	{
+		const bool valid = (count >= 3);
+		VertexGroup& group = BeginFaces(valid && ObjTokenizer::HasNormals(format), valid && ObjTokenizer::HasTexCoords(format));
+		if(!valid)
+			return;
+
+		size_t numTriangles = AddFace(vertices, count, format, mFile.mVertices.size(), mFile.mTexCoords.size(), mFile.mNormals.size(), mFile.mPolygonMode, mFile.mTriangles, mFile.mQuads);
+		if(numTriangles)
+			group.numTriangles += numTriangles;
+		else
+			group.numQuads++;
+	}
+
+	/// Append a run of consecutive faces that was parsed separately
+	/** Has the same effect on vertex groups as calling Face() for each of them. */
+	void Faces(const Triangle* triangles, size_t numTriangles, const Quad* quads, size_t numQuads, bool hasNormals, bool hasTexCoords)
+	{
+		VertexGroup& group = BeginFaces(hasNormals, hasTexCoords);
+		mFile.mTriangles.insert(mFile.mTriangles.end(), triangles, triangles + numTriangles);
+		mFile.mQuads.insert(mFile.mQuads.end(), quads, quads + numQuads);
+		group.numTriangles += numTriangles;
+		group.numQuads += numQuads;
+	}
+
+	/// Resolve and check indices, then append face
+	/** @param format Determines which of texture coordinates and normals are
+			present. Absent ones are stored as the maximum index value.
+		@param numVertices Number of vertices defined before the face. Same for
+			numTexCoords and numNormals.
+		@returns Number of triangles added, or zero if a quad was added.
+		@throw std::runtime_error if an index is outside its list. */
+	static size_t AddFace(
+			const FaceVertex vertices[],
+			size_t count,
+			FaceFormat format,
+			size_t numVertices,
+			size_t numTexCoords,
+			size_t numNormals,
+			ObjPolygonMode polygonMode,
+			std::vector<Triangle>& triangles,
+			std::vector<Quad>& quads);
+
+private:
+	/// Convert negative indices, which are relative to the end of the list, and check range
+	/** @returns 1-based index. */
+	static int Resolve(int32_t index, size_t listSize)
+	{
+		const int64_t resolved = index < 0 ? int64_t(listSize) + index + 1 : index;
+		if(resolved < 1 || resolved > int64_t(listSize))
+			throw std::runtime_error("ObjFile: Non-existent vertex, texture coordinate or normal referenced.");
+		return int(resolved);
+	}
+
+	VertexGroup& BeginFaces(bool hasNormals, bool hasTexCoords)
+	{
+		/* Blender changes materials without creating vertex groups, so
+			create vertex group if material changed: */
+		if(mNewMaterial)
 		{
-			const char* material = line + 7; // Skip "usemtl "
-			if(!mVertexGroups.empty() && mVertexGroups.back().material.empty())
-				mVertexGroups.back().material = material;
-			else
-			{
-				currentMaterial = material;
-				newMaterial = true;
-			}
+			mFile.NewVertexGroup(mCurrentMaterial, mCurrentMaterial);
+			mNewMaterial = false;
 		}
-		else if(!strncmp(line, "mtllib", 6))
+
+		if(mFile.mVertexGroups.empty())
+			throw std::runtime_error("Face definition without vertex group");
+
+		VertexGroup& group = mFile.mVertexGroups.back();
+		group.hasNormals = hasNormals;
+		group.hasTexCoords = hasTexCoords;
+		return group;
+	}
+
+	ObjFileT& mFile;
+	std::string mCurrentMaterial;
+	bool mNewMaterial = false;
+};
+
+template<typename TIndex>
+size_t ObjFileT<TIndex>::Reader::AddFace(
+		const FaceVertex vertices[],
+		size_t count,
+		FaceFormat format,
+		size_t numVertices,
+		size_t numTexCoords,
+		size_t numNormals,
+		ObjPolygonMode polygonMode,
+		std::vector<Triangle>& triangles,
+		std::vector<Quad>& quads)
+{
+	// The maximum value marks absent texture coordinates and normals:
+	const int64_t kMaxIndex = std::numeric_limits<TIndex>::max();
+	const bool hasTexCoords = ObjTokenizer::HasTexCoords(format);
+	const bool hasNormals = ObjTokenizer::HasNormals(format);
+
+	// Without triangulation, polygons with more than four vertices are cut off after the fourth:
+	const size_t corners = (polygonMode == ObjPolygonMode::kTriangulate) ? count : std::min<size_t>(count, 4);
+	for(size_t i = 0; i < corners; ++i)
+	{
+		Resolve(vertices[i].vertex, numVertices);
+		if(hasTexCoords)
+			Resolve(vertices[i].texCoord, numTexCoords);
+		if(hasNormals)
+			Resolve(vertices[i].normal, numNormals);
+	}
+
+	// Indices count from 1, 0 becomes the absent marker in Face:
+	int v[4] = {0, 0, 0, 0};
+	int t[4] = {0, 0, 0, 0};
+	int n[4] = {0, 0, 0, 0};
+	auto setCorner = [&](int i, const FaceVertex& vertex)
+	{
+		v[i] = Resolve(vertex.vertex, numVertices);
+		t[i] = hasTexCoords ? Resolve(vertex.texCoord, numTexCoords) : 0;
+		n[i] = hasNormals ? Resolve(vertex.normal, numNormals) : 0;
+		if(v[i] - 1 >= kMaxIndex || t[i] - 1 >= kMaxIndex || n[i] - 1 >= kMaxIndex)
+			throw std::range_error("ObjFile: Index exceeds range of index type. Use ObjFile32.");
+	};
+
+	if(corners == 4 && polygonMode == ObjPolygonMode::kQuads)
+	{
+		for(int i = 0; i < 4; ++i)
+			setCorner(i, vertices[i]);
+		quads.push_back(Quad(v, t, n));
+		return 0;
+	}
+
+	// Triangle fan around the first vertex:
+	setCorner(0, vertices[0]);
+	for(size_t i = 1; i + 1 < corners; ++i)
+	{
+		setCorner(1, vertices[i]);
+		setCorner(2, vertices[i + 1]);
+		triangles.push_back(Triangle(v, t, n));
+	}
+	return corners - 2;
+}
+
+/// Part of the text that is parsed in parallel with other chunks
+/** Parsing happens in two passes. The first pass parses vertex attributes and
+	remembers all other relevant lines. After the attribute counts of all
+	preceding chunks are known, the second pass parses faces with global
+	indices. Statements affecting vertex groups are recorded as events and
+	replayed in order by a Reader afterwards. */
+template<typename TIndex>
+struct ObjFileT<TIndex>::Chunk
+{
+	using FaceVertex = ObjTokenizer::FaceVertex;
+	using FaceFormat = ObjTokenizer::FaceFormat;
+
+	/// Run of consecutive faces or a statement affecting vertex groups
+	struct Event
+	{
+		enum Type
+		{
+			kFaces,
+			kGroup,
+			kObject,
+			kUseMaterial,
+			kMaterialLibrary
+		};
+
+		Type type;
+		std::string name;
+		size_t numTriangles;
+		size_t numQuads;
+		bool hasNormals;
+		bool hasTexCoords;
+	};
+
+	/// Line to be parsed in the second pass
+	struct DeferredLine
+	{
+		std::string_view text;
+
+		/// Number of attributes in this chunk preceding the line
+		size_t numVertices, numTexCoords, numNormals;
+	};
+
+	/// First pass: Parse vertex attributes
+	void ParseAttributes(float scale)
+	{
+		ObjTokenizer tokenizer;
+		TextLineReader lines(text);
+		std::string_view line;
+		mScale = scale;
+		while(lines.GetNextLine(line))
 		{
-			mMtlLibFiles.push_back(line + 7);
+			if(line.empty())
+				continue;
+			switch(line[0])
+			{
+			case 'v':
+				tokenizer.ParseLine(line, *this);
+				break;
+
+			case 'f':
+			case 'g':
+			case 'o':
+			case 'u':
+			case 'm':
+				deferredLines.push_back(DeferredLine{line, vertices.size(), texCoords.size(), normals.size()});
+				break;
+			}
 		}
-		else if(line[0] == 'o')
+	}
+
+	/// Second pass: Parse faces and statements affecting vertex groups
+	void ParseDeferredLines()
+	{
+		ObjTokenizer tokenizer;
+		for(auto& line: deferredLines)
 		{
-			NewVertexGroup(line + 2, "");
+			mCurrentLine = &line;
+			tokenizer.ParseLine(line.text, *this);
 		}
+		deferredLines.clear();
+		deferredLines.shrink_to_fit();
 	}
+
+	void Vertex(Vector3 v)
+	{
+		v *= mScale;
+		vertices.push_back(v);
+		boundingBox.Stretch(v);
+	}
+
+	void TexCoord(const Vector2& uv) {texCoords.push_back(Vector2(uv[0], 1 - uv[1]));}
+	void Normal(const Vector3& n) {normals.push_back(n);}
+	void Group(std::string_view name) {AddEvent(Event::kGroup, name);}
+	void Object(std::string_view name) {AddEvent(Event::kObject, name);}
+	void UseMaterial(std::string_view name) {AddEvent(Event::kUseMaterial, name);}
+	void MaterialLibrary(std::string_view file) {AddEvent(Event::kMaterialLibrary, file);}
+
+	void Face(const FaceVertex faceVertices[], size_t count, FaceFormat format)
+	{
+		if(events.empty() || events.back().type != Event::kFaces)
+			events.push_back(Event{Event::kFaces, std::string(), 0, 0, false, false});
+
+		Event& event = events.back();
+		const bool valid = (count >= 3);
+		event.hasNormals = valid && ObjTokenizer::HasNormals(format);
+		event.hasTexCoords = valid && ObjTokenizer::HasTexCoords(format);
+		if(!valid)
+			return;
+
+		assert(mCurrentLine);
+		size_t numTriangles = Reader::AddFace(
+				faceVertices,
+				count,
+				format,
+				vertexBase + mCurrentLine->numVertices,
+				texCoordBase + mCurrentLine->numTexCoords,
+				normalBase + mCurrentLine->numNormals,
+				polygonMode,
+				triangles,
+				quads);
+		if(numTriangles)
+			event.numTriangles += numTriangles;
+		else
+			event.numQuads++;
+	}
+
+	void AddEvent(typename Event::Type type, std::string_view name)
+	{
+		events.push_back(Event{type, std::string(name), 0, 0, false, false});
+	}
+
+	std::string_view text;
+
+	std::vector<Vector3> vertices;
+	std::vector<Vector2> texCoords;
+	std::vector<Vector3> normals;
+	util::AxisAlignedBox boundingBox;
+	std::vector<DeferredLine> deferredLines;
+
+	/// Number of attributes in all preceding chunks
+	size_t vertexBase = 0, texCoordBase = 0, normalBase = 0;
+
+	ObjPolygonMode polygonMode = ObjPolygonMode::kQuads;
+
+	std::vector<Triangle> triangles;
+	std::vector<Quad> quads;
+	std::vector<Event> events;
+
+private:
+	float mScale = 1.0f;
+	const DeferredLine* mCurrentLine = nullptr;
+};
+
+template<typename TIndex>
+ObjFileT<TIndex>::ObjFileT(TextReadStreamBase& stream, float scale, ObjPolygonMode polygonMode) :
+	mScale(scale),
+	mPolygonMode(polygonMode)
+{
+	ObjTokenizer tokenizer;
+	Reader reader(*this);
+	const char* line;
+	while((line = stream.GetNextLine()))
+		tokenizer.ParseLine(line, reader);
 }
 
+template<typename TIndex>
+ObjFileT<TIndex>::ObjFileT(std::string_view text, float scale, ObjPolygonMode polygonMode) :
+	mScale(scale),
+	mPolygonMode(polygonMode)
+{
+	ObjTokenizer tokenizer;
+	Reader reader(*this);
+	TextLineReader lines(text);
+	std::string_view line;
+	while(lines.GetNextLine(line))
+		tokenizer.ParseLine(line, reader);
+}
 
-void ObjFile::CalculateNormals()
+template<typename TIndex>
+ObjFileT<TIndex>::ObjFileT(const MappedFile& file, float scale, ObjPolygonMode polygonMode) :
+	ObjFileT(file.GetText(), scale, polygonMode)
 {
-	assert(!mVertices.empty());
+}
 
-	mNormals.clear();
-	mNormals.resize(mVertices.size(), Vector3(0.0, 0.0, 0.0));
+template<typename TIndex>
+ObjFileT<TIndex>::ObjFileT(std::string_view text, TaskDispatcher& dispatcher, float scale, ObjPolygonMode polygonMode) :
+	mScale(scale),
+	mPolygonMode(polygonMode)
+{
+	// Split at line boundaries:
+	std::vector<Chunk> chunks;
+	const char* textEnd = text.data() + text.size();
+	for(const char* chunkBegin = text.data(); chunkBegin != textEnd;)
+	{
+		const char* chunkEnd = chunkBegin + std::min(kChunkSize, size_t(textEnd - chunkBegin));
+		if(chunkEnd != textEnd)
+		{
+			auto newline = static_cast<const char*>(std::memchr(chunkEnd, '\n', textEnd - chunkEnd));
+			chunkEnd = newline ? newline + 1 : textEnd;
+		}
+		chunks.emplace_back();
+		chunks.back().text = std::string_view(chunkBegin, chunkEnd - chunkBegin);
+		chunks.back().polygonMode = polygonMode;
+		chunkBegin = chunkEnd;
+	}
 
-	std::vector<uint8_t> normalDenoms(mNormals.size() / 3, 0);
+	ParallelFor(dispatcher, chunks.size(), [&](size_t i){chunks[i].ParseAttributes(scale);});
 
-	for(auto q: mQuads)
+	size_t numVertices = 0, numTexCoords = 0, numNormals = 0;
+	for(auto& chunk: chunks)
 	{
-		Vector3 p0 = GetVertex(q, 0);
-		Vector3 p1 = GetVertex(q, 1);
-		Vector3 p2 = GetVertex(q, 2);
-		Vector3 p3 = GetVertex(q, 3);
+		chunk.vertexBase = numVertices;
+		chunk.texCoordBase = numTexCoords;
+		chunk.normalBase = numNormals;
+		numVertices += chunk.vertices.size();
+		numTexCoords += chunk.texCoords.size();
+		numNormals += chunk.normals.size();
+		mBoundingBox.Stretch(chunk.boundingBox);
+	}
+	mVertices.resize(numVertices);
+	mTexCoords.resize(numTexCoords);
+	mNormals.resize(numNormals);
 
-		AddNormal(p0, p1, p3, mNormals[q.vertexIndices[0]]);
-		AddNormal(p1, p2, p0, mNormals[q.vertexIndices[1]]);
-		AddNormal(p2, p3, p1, mNormals[q.vertexIndices[2]]);
-		AddNormal(p3, p0, p2, mNormals[q.vertexIndices[3]]);
+	ParallelFor(dispatcher, chunks.size(), [&](size_t i)
+	{
+		Chunk& chunk = chunks[i];
+		std::copy(chunk.vertices.begin(), chunk.vertices.end(), mVertices.begin() + chunk.vertexBase);
+		std::copy(chunk.texCoords.begin(), chunk.texCoords.end(), mTexCoords.begin() + chunk.texCoordBase);
+		std::copy(chunk.normals.begin(), chunk.normals.end(), mNormals.begin() + chunk.normalBase);
+		chunk.vertices = std::vector<Vector3>();
+		chunk.texCoords = std::vector<Vector2>();
+		chunk.normals = std::vector<Vector3>();
+		chunk.ParseDeferredLines();
+	});
 
-		for(int i = 0; i < 4; ++i)
+	// Merge faces and vertex groups in file order:
+	size_t numTriangles = 0, numQuads = 0;
+	for(auto& chunk: chunks)
+	{
+		numTriangles += chunk.triangles.size();
+		numQuads += chunk.quads.size();
+	}
+	mTriangles.reserve(numTriangles);
+	mQuads.reserve(numQuads);
+
+	Reader reader(*this);
+	for(auto& chunk: chunks)
+	{
+		const Triangle* triangles = chunk.triangles.data();
+		const Quad* quads = chunk.quads.data();
+		for(auto& event: chunk.events)
+		{
+			switch(event.type)
+			{
+			case Chunk::Event::kFaces:
+				reader.Faces(triangles, event.numTriangles, quads, event.numQuads, event.hasNormals, event.hasTexCoords);
+				triangles += event.numTriangles;
+				quads += event.numQuads;
+				break;
+			case Chunk::Event::kGroup: reader.Group(event.name); break;
+			case Chunk::Event::kObject: reader.Object(event.name); break;
+			case Chunk::Event::kUseMaterial: reader.UseMaterial(event.name); break;
+			case Chunk::Event::kMaterialLibrary: reader.MaterialLibrary(event.name); break;
+			}
+		}
+		chunk = Chunk();
+	}
+}
+
+template<typename TIndex>
+ObjFileT<TIndex>::ObjFileT(const MappedFile& file, TaskDispatcher& dispatcher, float scale, ObjPolygonMode polygonMode) :
+	ObjFileT(file.GetText(), dispatcher, scale, polygonMode)
+{
+}
+
+template<typename TIndex>
+ObjFileT<TIndex> ObjFileT<TIndex>::LoadCached(const std::string& path, const std::string& cachePath, float scale, ObjPolygonMode polygonMode)
+{
+	MappedFile source(path);
+	const CacheSource cacheSource(source.GetData(), source.GetSize());
+
+	std::optional<ObjFileT> cached;
+	try
+	{
+		MappedFile cache(cachePath);
+		cached = FromCache(cache.GetData(), cache.GetSize(), cacheSource, scale, polygonMode);
+	}
+	catch(std::runtime_error&)
+	{
+		// No cache yet
+	}
+	if(cached)
+		return std::move(*cached);
+
+	ObjFileT file(source, scale, polygonMode);
+
+	// Other processes may have the old cache mapped, so never truncate it. Replace it atomically instead:
+	const std::string tempPath = TemporaryPath(cachePath);
+	try
+	{
 		{
-			normalDenoms[q.vertexIndices[i]] += 1;
-			q.normalIndices[i] = q.vertexIndices[i];
+			FileWriteStorage storage(tempPath);
+			file.WriteCache(storage, cacheSource);
+			storage.Flush();
 		}
+		if(std::rename(tempPath.c_str(), cachePath.c_str()) != 0)
+			throw std::runtime_error(cachePath + " could not be replaced: " + StringUtils::StrError(errno));
+	}
+	catch(std::exception&)
+	{
+		// Read-only or full cache location, the parsed file is still valid
+		std::remove(tempPath.c_str());
+	}
+	return file;
+}
+
+template<typename TIndex>
+void ObjFileT<TIndex>::WriteCache(WriteStorage& storage, const CacheSource& source) const
+{
+	std::string strings;
+	auto addString = [&strings](const std::string& str)
+	{
+		CacheString ref = {uint32_t(strings.size()), uint32_t(str.size())};
+		strings += str;
+		return ref;
+	};
+
+	std::vector<CacheVertexGroup> groups;
+	groups.reserve(mVertexGroups.size());
+	for(auto& group: mVertexGroups)
+	{
+		CacheVertexGroup out;
+		out.name = addString(group.name);
+		out.material = addString(group.material);
+		out.firstQuad = group.firstQuad;
+		out.numQuads = group.numQuads;
+		out.firstTriangle = group.firstTriangle;
+		out.numTriangles = group.numTriangles;
+		out.hasNormals = group.hasNormals;
+		out.hasTexCoords = group.hasTexCoords;
+		groups.push_back(out);
 	}
 
-	for(auto& t: mTriangles)
+	std::vector<CacheString> mtlLibFiles;
+	for(auto& file: mMtlLibFiles)
+		mtlLibFiles.push_back(addString(file));
+
+	CacheHeader header;
+	std::memcpy(header.magic, CacheHeader::kMagic, sizeof(header.magic));
+	header.version = CacheHeader::kVersion;
+	header.indexSize = sizeof(TIndex);
+	header.sourceHash = source.hash;
+	header.sourceSize = source.size;
+	header.scale = mScale;
+	header.polygonMode = uint32_t(mPolygonMode);
+	header.numVertexGroups = uint32_t(groups.size());
+	header.numMtlLibFiles = uint32_t(mtlLibFiles.size());
+	header.stringBytes = uint32_t(strings.size());
+	header.numVertices = mVertices.size();
+	header.numTexCoords = mTexCoords.size();
+	header.numNormals = mNormals.size();
+	header.numQuads = mQuads.size();
+	header.numTriangles = mTriangles.size();
+	for(int i = 0; i < 3; ++i)
 	{
-		Vector3 p0 = GetVertex(t, 0);
-		Vector3 p1 = GetVertex(t, 1);
-		Vector3 p2 = GetVertex(t, 2);
-		Vector3 v1 = p1 - p0;
-		Vector3 v2 = p2 - p0;
+		header.boundingBox[i] = mBoundingBox.GetMin(i);
+		header.boundingBox[i + 3] = mBoundingBox.GetMax(i);
+	}
+
+	storage.Write(&header, sizeof(header));
+	WriteArray(storage, mVertices.data(), mVertices.size());
+	WriteArray(storage, mTexCoords.data(), mTexCoords.size());
+	WriteArray(storage, mNormals.data(), mNormals.size());
+	WriteArray(storage, mQuads.data(), mQuads.size());
+	WriteArray(storage, mTriangles.data(), mTriangles.size());
+	WriteArray(storage, groups.data(), groups.size());
+	WriteArray(storage, mtlLibFiles.data(), mtlLibFiles.size());
+	storage.Write(strings.data(), strings.size());
+}
+
+template<typename TIndex>
+std::optional<ObjFileT<TIndex>> ObjFileT<TIndex>::FromCache(const void* data, size_t size, const CacheSource& source, float scale, ObjPolygonMode polygonMode)
+{
+	if(size < sizeof(CacheHeader))
+		return std::nullopt;
+
+	CacheHeader header;
+	std::memcpy(&header, data, sizeof(header));
+	if(std::memcmp(header.magic, CacheHeader::kMagic, sizeof(header.magic))
+			|| header.version != CacheHeader::kVersion
+			|| header.indexSize != sizeof(TIndex)
+			|| header.sourceHash != source.hash
+			|| header.sourceSize != source.size
+			|| header.scale != scale
+			|| header.polygonMode != uint32_t(polygonMode))
+		return std::nullopt;
 
-		Vector3 n = v1.CrossProduct(v2);
-		n.SetLength(1.0);
-		for(int i = 0; i < 3; ++i)
+	ObjFileT file(scale, polygonMode);
+	CacheReader reader(data, size);
+	std::vector<CacheVertexGroup> groups;
+	std::vector<CacheString> mtlLibFiles;
+	if(!reader.ReadArray(file.mVertices, header.numVertices)
+			|| !reader.ReadArray(file.mTexCoords, header.numTexCoords)
+			|| !reader.ReadArray(file.mNormals, header.numNormals)
+			|| !reader.ReadArray(file.mQuads, header.numQuads)
+			|| !reader.ReadArray(file.mTriangles, header.numTriangles)
+			|| !reader.ReadArray(groups, header.numVertexGroups)
+			|| !reader.ReadArray(mtlLibFiles, header.numMtlLibFiles))
+		return std::nullopt;
+
+	const std::string_view strings = reader.GetRemainder();
+	if(strings.size() != header.stringBytes)
+		return std::nullopt;
+
+	// Vertex indices are used by all faces, texture coordinates and normals only if the group has them:
+	if(!file.FacesValid(file.mQuads.data(), file.mQuads.size(), false, false)
+			|| !file.FacesValid(file.mTriangles.data(), file.mTriangles.size(), false, false))
+		return std::nullopt;
+
+	bool valid = true;
+	auto getString = [&](const CacheString& ref)
+	{
+		if(ref.offset > strings.size() || ref.length > strings.size() - ref.offset)
 		{
-			mNormals[t.vertexIndices[i]] += n;
-			normalDenoms[t.vertexIndices[i]] += 1;
-			t.normalIndices[i] = t.vertexIndices[i];
+			valid = false;
+			return std::string();
 		}
+		return std::string(strings.substr(ref.offset, ref.length));
+	};
+
+	file.mVertexGroups.reserve(groups.size());
+	for(auto& in: groups)
+	{
+		VertexGroup group;
+		group.name = getString(in.name);
+		group.firstQuad = in.firstQuad;
+		group.numQuads = in.numQuads;
+		group.firstTriangle = in.firstTriangle;
+		group.numTriangles = in.numTriangles;
+		group.material = getString(in.material);
+		group.hasNormals = in.hasNormals;
+		group.hasTexCoords = in.hasTexCoords;
+		if(size_t(group.firstQuad) + group.numQuads > file.mQuads.size()
+				|| size_t(group.firstTriangle) + group.numTriangles > file.mTriangles.size())
+			return std::nullopt;
+		if(!file.FacesValid(file.mQuads.data() + group.firstQuad, group.numQuads, group.hasTexCoords, group.hasNormals)
+				|| !file.FacesValid(file.mTriangles.data() + group.firstTriangle, group.numTriangles, group.hasTexCoords, group.hasNormals))
+			return std::nullopt;
+		file.mVertexGroups.push_back(std::move(group));
 	}
+	for(auto& ref: mtlLibFiles)
+		file.mMtlLibFiles.push_back(getString(ref));
+	if(!valid)
+		return std::nullopt;
+
+	file.mBoundingBox = AxisAlignedBox(header.boundingBox[0], header.boundingBox[1], header.boundingBox[2],
+			header.boundingBox[3], header.boundingBox[4], header.boundingBox[5]);
+	return file;
+}
 
-	for(size_t i = 0; i < normalDenoms.size(); i++)
+template<typename TIndex>
+template<int vertices>
+bool ObjFileT<TIndex>::FacesValid(const Face<vertices>* faces, size_t count, bool hasTexCoords, bool hasNormals) const
+{
+	for(size_t i = 0; i < count; ++i)
 	{
-		mNormals[i] /= normalDenoms[i];
+		for(int j = 0; j < vertices; ++j)
+		{
+			if(faces[i].vertexIndices[j] >= mVertices.size()
+					|| (hasTexCoords && faces[i].texCoordIndices[j] >= mTexCoords.size())
+					|| (hasNormals && faces[i].normalIndices[j] >= mNormals.size()))
+				return false;
+		}
 	}
+	return true;
+}
+
+template<typename TIndex>
+void ObjFileT<TIndex>::CalculateNormals(ObjNormalWeighting weighting)
+{
+	CalculateNormalsImpl(weighting, [](size_t count, auto function)
+	{
+		for(size_t i = 0; i < count; ++i)
+			function(i);
+	});
+}
+
+template<typename TIndex>
+void ObjFileT<TIndex>::CalculateNormals(TaskDispatcher& dispatcher, ObjNormalWeighting weighting)
+{
+	CalculateNormalsImpl(weighting, [&dispatcher](size_t count, auto function)
+	{
+		ParallelFor(dispatcher, count, function);
+	});
+}
+
+template<typename TIndex>
+template<class TParallelFor>
+void ObjFileT<TIndex>::CalculateNormalsImpl(ObjNormalWeighting weighting, TParallelFor parallelFor)
+{
+	NormalCalculator<Triangle, Quad> calculator(mVertices, mTriangles, mQuads, weighting);
+	parallelFor(calculator.GetNumFaceTasks(), [&](size_t task){calculator.ComputeFaceNormals(task);});
+	calculator.BuildAdjacency();
+	mNormals.resize(mVertices.size());
+	parallelFor(calculator.GetNumVertexTasks(), [&](size_t task){calculator.GatherVertexNormals(task, mNormals.data());});
+
+	for(auto& quad: mQuads)
+		quad.normalIndices = quad.vertexIndices;
+	for(auto& triangle: mTriangles)
+		triangle.normalIndices = triangle.vertexIndices;
+	for(auto& group: mVertexGroups)
+		group.hasNormals = true;
 }
 
-void ObjFile::NewVertexGroup(const std::string& name, const std::string& material)
+template<typename TIndex>
+void ObjFileT<TIndex>::NewVertexGroup(const std::string& name, const std::string& material)
 {
 	VertexGroup group;
 	group.name = name;
@@ -243,8 +1087,13 @@ void ObjFile::NewVertexGroup(const std::string& name, const std::string& materia
 	group.firstTriangle = mTriangles.size();
 	group.numTriangles = 0;
 	group.material = material;
+	group.hasNormals = false;
+	group.hasTexCoords = false;
 	mVertexGroups.push_back(group);
 }
 
+template class ObjFileT<uint16_t>;
+template class ObjFileT<uint32_t>;
+
 }
 } // namespace molecular
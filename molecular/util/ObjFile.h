@@ -29,22 +29,117 @@ SOFTWARE.
 #include <molecular/util/Vector3.h>
 #include <molecular/util/AxisAlignedBox.h>
 #include <molecular/util/TextStream.h>
+#include <molecular/util/MappedFile.h>
+#include <molecular/util/TaskDispatcher.h>
+#include <molecular/util/Hash.h>
+#include <molecular/util/StreamStorage.h>
 #include <vector>
 #include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
 
 namespace molecular
 {
 namespace util
 {
 
+/// How ObjFile stores faces with more than three vertices
+enum class ObjPolygonMode
+{
+	/// Store faces with four vertices as quads
+	/** Faces with more than four vertices are cut off after the fourth. */
+	kQuads,
+
+	/// Fan-triangulate all faces, including quads, while parsing
+	/** Polygons are assumed to be convex. No quads are stored in this mode. */
+	kTriangulate
+};
+
+/// How face normals are weighted when ObjFile averages them to vertex normals
+enum class ObjNormalWeighting
+{
+	/// Every adjacent face contributes equally
+	kUniform,
+
+	/// Faces contribute proportionally to their area
+	kArea,
+
+	/// Faces contribute proportionally to their interior angle at the vertex
+	/** Most independent of the tessellation. */
+	kAngle
+};
+
 /// Reads 3D models in .obj text files
-class ObjFile
+/** @tparam TIndex Type of the indices stored in faces. Use uint16_t for compact
+		storage of small meshes, and uint32_t for meshes with more than 65535
+		vertices, texture coordinates or normals. Parsing throws std::range_error
+		if an index does not fit.
+	@see ObjFile, ObjFile32, ObjFileUtils::RequiresWideIndices() */
+template<typename TIndex>
+class ObjFileT
 {
 public:
-	explicit ObjFile(TextReadStreamBase& stream, float scale = 1.0f);
+	using Index = TIndex;
+
+	explicit ObjFileT(TextReadStreamBase& stream, float scale = 1.0f, ObjPolygonMode polygonMode = ObjPolygonMode::kQuads);
+
+	/// Parse text in memory
+	/** Lines are tokenized in place without being copied. */
+	explicit ObjFileT(std::string_view text, float scale = 1.0f, ObjPolygonMode polygonMode = ObjPolygonMode::kQuads);
+
+	/// Parse memory-mapped file
+	explicit ObjFileT(const MappedFile& file, float scale = 1.0f, ObjPolygonMode polygonMode = ObjPolygonMode::kQuads);
+
+	/// Parse text in memory using multiple threads
+	/** The text is split into chunks at line boundaries, which are parsed
+		concurrently. The result is identical to the single-threaded parse. */
+	ObjFileT(std::string_view text, TaskDispatcher& dispatcher, float scale = 1.0f, ObjPolygonMode polygonMode = ObjPolygonMode::kQuads);
+
+	/// Parse memory-mapped file using multiple threads
+	ObjFileT(const MappedFile& file, TaskDispatcher& dispatcher, float scale = 1.0f, ObjPolygonMode polygonMode = ObjPolygonMode::kQuads);
+
+	/// Identifies the OBJ text a binary cache was written for
+	struct CacheSource
+	{
+		/// Calculate from OBJ text
+		CacheSource(const void* data, size_t size) : hash(Murmur::HashData(data, size)), size(size) {}
+
+		/// Murmur::HashData() of the text
+		Hash hash;
 
-	/** Call after applying morph targets. */
-	void CalculateNormals();
+		/// Size of the text in bytes, guards against hash collisions
+		uint64_t size;
+	};
+
+	/// Parse file, or load it from a binary cache if that is up to date
+	/** The cache is keyed by a hash and the size of the file contents, the scale
+		and the polygon mode. If cachePath does not exist or was written for
+		different input, the OBJ file is parsed and the cache is (re)written.
+		The new cache is written to a temporary file that replaces cachePath,
+		so concurrent loads see either the old or the new cache completely.
+		Failing to write the cache is not an error.
+		@see WriteCache(), FromCache() */
+	static ObjFileT LoadCached(const std::string& path, const std::string& cachePath, float scale = 1.0f, ObjPolygonMode polygonMode = ObjPolygonMode::kQuads);
+
+	/// Serialize parsed state into a flat binary
+	void WriteCache(WriteStorage& storage, const CacheSource& source) const;
+
+	/// Load from data written by WriteCache()
+	/** Typically data points to a MappedFile. Arrays are copied out of it.
+		@returns Nothing if the data is truncated, corrupt, was written by an
+			incompatible version or for a different source, scale or polygon mode. */
+	static std::optional<ObjFileT> FromCache(const void* data, size_t size, const CacheSource& source, float scale = 1.0f, ObjPolygonMode polygonMode = ObjPolygonMode::kQuads);
+
+	/// Calculate smooth vertex normals
+	/** Replaces the normals with one unit normal per vertex, and makes all
+		faces and vertex groups use them. Vertices without adjacent faces get
+		a zero normal. Call after applying morph targets. */
+	void CalculateNormals(ObjNormalWeighting weighting = ObjNormalWeighting::kUniform);
+
+	/// Calculate smooth vertex normals using multiple threads
+	/** The result is identical to the single-threaded version. */
+	void CalculateNormals(TaskDispatcher& dispatcher, ObjNormalWeighting weighting = ObjNormalWeighting::kUniform);
 
 	/// Face structure templated over the number of vertices
 	/** A face consists usually of three or four vertices. This structure
@@ -65,9 +160,9 @@ public:
 			}
 		}
 
-		std::array<uint16_t, vertices> vertexIndices;
-		std::array<uint16_t, vertices> texCoordIndices;
-		std::array<uint16_t, vertices> normalIndices;
+		std::array<TIndex, vertices> vertexIndices;
+		std::array<TIndex, vertices> texCoordIndices;
+		std::array<TIndex, vertices> normalIndices;
 	};
 
 	typedef Face<4> Quad; ///< Face with four vertices (quad)
@@ -101,6 +196,9 @@ public:
 	const util::AxisAlignedBox& GetBoundingBox() const {return mBoundingBox;}
 
 protected:
+	/// Empty file, to be filled by FromCache()
+	ObjFileT(float scale, ObjPolygonMode polygonMode) : mScale(scale), mPolygonMode(polygonMode) {}
+
 	/// Vertex coordinates
 	std::vector<Vector3> mVertices;
 	std::vector<Vector2> mTexCoords;
@@ -121,25 +219,37 @@ protected:
 		return mVertices[face.vertexIndices[i]];
 	}
 
-	/** Used by CalculateNormals. */
-	inline void AddNormal(const Vector3& p0, const Vector3& p1, const Vector3& p2, Vector3& outNormal)
-	{
-		Vector3 v1 = p1 - p0;
-		Vector3 v2 = p2 - p0;
-
-		Vector3 n = v1.CrossProduct(v2);
-		n.SetLength(1.0);
+	/// Check that all indices used by the faces are in range
+	/** Texture coordinate and normal indices are only checked if the group uses them. */
+	template<int vertices>
+	bool FacesValid(const Face<vertices>* faces, size_t count, bool hasTexCoords, bool hasNormals) const;
 
-		outNormal += n;
-	}
+	/// Calculate normals with the given ParallelFor-like function
+	template<class TParallelFor>
+	void CalculateNormalsImpl(ObjNormalWeighting weighting, TParallelFor parallelFor);
 
 	void NewVertexGroup(const std::string& name, const std::string& material);
 
+	/// Receives tokens from ObjTokenizer and fills in the data
+	class Reader;
+
+	/// Part of the text in parallel parsing
+	struct Chunk;
+
 	util::AxisAlignedBox mBoundingBox;
 	float mScale;
-
+	ObjPolygonMode mPolygonMode;
 };
 
+/// ObjFile with 16 bit indices
+using ObjFile = ObjFileT<uint16_t>;
+
+/// ObjFile with 32 bit indices
+using ObjFile32 = ObjFileT<uint32_t>;
+
+extern template class ObjFileT<uint16_t>;
+extern template class ObjFileT<uint32_t>;
+
 }
 } // namespace molecular
 
@@ -25,7 +25,13 @@ SOFTWARE.
 
 #include "ObjFileUtils.h"
 
-#include <molecular/util/MeshUtils.h>
+#include <molecular/util/ObjTokenizer.h>
+#include <molecular/util/ParallelFor.h>
+
+#include <atomic>
+#include <limits>
+#include <optional>
+#include <thread>
 
 namespace molecular
 {
@@ -34,18 +40,238 @@ namespace util
 namespace ObjFileUtils
 {
 
-using QuadRange = Range<std::vector<ObjFile::Quad>::const_iterator>;
-using TriangleRange = Range<std::vector<ObjFile::Triangle>::const_iterator>;
+namespace
+{
+
+/// Create mesh from unified buffers
+/** Normals and texture coordinates are omitted if empty. */
+Mesh MakeMesh(
+		std::vector<uint32_t>&& indices,
+		const std::vector<Vector3>& positions,
+		const std::vector<Vector3>& normals,
+		const std::vector<Vector2>& uvs,
+		const std::string& material)
+{
+	Mesh mesh(positions.size());
+	mesh.SetAttributeData(VertexAttributeInfo::kPosition, positions.data(), positions.size());
+	if(!normals.empty())
+		mesh.SetAttributeData(VertexAttributeInfo::kNormal, normals.data(), normals.size());
+	if(!uvs.empty())
+		mesh.SetAttributeData(VertexAttributeInfo::kTextureCoords, uvs.data(), uvs.size());
+	mesh.GetIndices() = std::move(indices);
+	mesh.SetMaterial(material);
+	return mesh;
+}
+
+template<typename TIndex>
+Mesh VertexGroupMesh(
+		const ObjFileT<TIndex>& objFile,
+		const typename ObjFileT<TIndex>::VertexGroup& vg,
+		VertexGroupScratch& scratch)
+{
+	std::vector<uint32_t> indices;
+	std::vector<Vector3> positions, normals;
+	std::vector<Vector2> uvs;
+	ObjVertexGroupBuffers(objFile, vg, indices, positions, normals, uvs, scratch);
+	return MakeMesh(std::move(indices), positions, normals, uvs, vg.material);
+}
+
+/// ObjTokenizer actor for StreamMeshes()
+class MeshStreamer
+{
+public:
+	using FaceVertex = ObjTokenizer::FaceVertex;
+	using FaceFormat = ObjTokenizer::FaceFormat;
+
+	MeshStreamer(const MeshCallback& callback, float scale) :
+		mCallback(callback),
+		mScale(scale)
+	{}
+
+	void Vertex(const Vector3& v) {mPositions.push_back(v * mScale);}
+	void TexCoord(const Vector2& uv) {mUvs.push_back(Vector2(uv[0], 1 - uv[1]));}
+	void Normal(const Vector3& n) {mNormals.push_back(n);}
+	void MaterialLibrary(std::string_view) {}
+
+	void Group(std::string_view name)
+	{
+		NewGroup(std::string(name), mCurrentMaterial);
+		mNewMaterial = false;
+	}
+
+	void Object(std::string_view name)
+	{
+		NewGroup(std::string(name), std::string());
+	}
+
+	void UseMaterial(std::string_view material)
+	{
+		if(mHasGroup && mGroupMaterial.empty())
+			mGroupMaterial = material;
+		else
+		{
+			mCurrentMaterial = material;
+			mNewMaterial = true;
+		}
+	}
+
+	void Face(const FaceVertex vertices[], size_t count, FaceFormat format);
+
+	/// Emit the current group, if it has faces
+	void Finish();
+
+private:
+	static uint32_t Resolve(int32_t index, size_t listSize)
+	{
+		// OBJ indices count from 1. Negative indices are relative to the end of the list.
+		return uint32_t(index < 0 ? int64_t(listSize) + index : int64_t(index) - 1);
+	}
+
+	void NewGroup(const std::string& name, const std::string& material)
+	{
+		Finish();
+		mGroupName = name;
+		mGroupMaterial = material;
+		mHasGroup = true;
+		mAllHaveNormals = true;
+		mAllHaveTexCoords = true;
+	}
+
+	const MeshCallback& mCallback;
+	float mScale;
+
+	// Shared attribute lists:
+	std::vector<Vector3> mPositions;
+	std::vector<Vector3> mNormals;
+	std::vector<Vector2> mUvs;
+
+	// Current group:
+	std::string mGroupName;
+	std::string mGroupMaterial;
+	bool mHasGroup = false;
+	bool mAllHaveNormals = true;
+	bool mAllHaveTexCoords = true;
+	std::vector<uint32_t> mPositionIndices, mNormalIndices, mUvIndices;
+	MeshUtils::UnifiedIndicesScratch mUnify;
+
+	std::string mCurrentMaterial;
+	bool mNewMaterial = false;
+};
+
+void MeshStreamer::Face(const FaceVertex vertices[], size_t count, FaceFormat format)
+{
+	/* Blender changes materials without creating vertex groups, so
+		create vertex group if material changed: */
+	if(mNewMaterial)
+	{
+		NewGroup(mCurrentMaterial, mCurrentMaterial);
+		mNewMaterial = false;
+	}
+
+	if(!mHasGroup)
+		throw std::runtime_error("Face definition without vertex group");
+
+	if(count < 3)
+		return;
+
+	const bool hasNormals = ObjTokenizer::HasNormals(format);
+	const bool hasTexCoords = ObjTokenizer::HasTexCoords(format);
+	mAllHaveNormals = mAllHaveNormals && hasNormals;
+	mAllHaveTexCoords = mAllHaveTexCoords && hasTexCoords;
+
+	uint32_t v[3], t[3], n[3];
+	for(size_t i = 0; i < count; ++i)
+	{
+		// Only elements declared before the face can be referenced:
+		uint32_t position = Resolve(vertices[i].vertex, mPositions.size());
+		if(position >= mPositions.size())
+			throw std::runtime_error("ObjFile: Non-existent vertex referenced.");
+		uint32_t texCoord = hasTexCoords ? Resolve(vertices[i].texCoord, mUvs.size()) : 0;
+		if(hasTexCoords && texCoord >= mUvs.size())
+			throw std::runtime_error("ObjFile: Non-existent texture coordinate referenced.");
+		uint32_t normal = hasNormals ? Resolve(vertices[i].normal, mNormals.size()) : 0;
+		if(hasNormals && normal >= mNormals.size())
+			throw std::runtime_error("ObjFile: Non-existent normal referenced.");
+
+		// Triangle fan around the first vertex:
+		const size_t corner = std::min<size_t>(i, 2);
+		if(i > 2)
+		{
+			v[1] = v[2];
+			t[1] = t[2];
+			n[1] = n[2];
+		}
+		v[corner] = position;
+		t[corner] = texCoord;
+		n[corner] = normal;
+
+		if(i >= 2)
+		{
+			mPositionIndices.insert(mPositionIndices.end(), v, v + 3);
+			mUvIndices.insert(mUvIndices.end(), t, t + 3);
+			mNormalIndices.insert(mNormalIndices.end(), n, n + 3);
+		}
+	}
+}
+
+void MeshStreamer::Finish()
+{
+	if(mPositionIndices.empty())
+		return;
+
+	const uint32_t* normalIndexData = mAllHaveNormals ? mNormalIndices.data() : nullptr;
+	const uint32_t* uvIndexData = mAllHaveTexCoords ? mUvIndices.data() : nullptr;
+
+	std::vector<uint32_t> indices;
+	std::vector<Vector3> positions, normals;
+	std::vector<Vector2> uvs;
+	MeshUtils::SeparateToUnifiedIndices(
+				mPositionIndices.size(),
+				mPositionIndices.data(),
+				normalIndexData,
+				uvIndexData,
+				mPositions.size(), mPositions.data(),
+				mNormals.size(), mNormals.data(),
+				mUvs.size(), mUvs.data(),
+				indices,
+				positions,
+				normals,
+				uvs,
+				mUnify);
+
+	Mesh mesh = MakeMesh(std::move(indices), positions, normals, uvs, mGroupMaterial);
+
+	mPositionIndices.clear();
+	mNormalIndices.clear();
+	mUvIndices.clear();
+
+	mCallback(mGroupName, std::move(mesh));
+}
+
+}
 
-/// Convert OBJ mesh data to data for three vertex buffers and one index buffer
-/** Index and vertex data is appended to the output vectors. */
+template<typename TIndex>
 void ObjVertexGroupBuffers(
-		const ObjFile& objFile,
-		const ObjFile::VertexGroup& vg,
+		const ObjFileT<TIndex>& objFile,
+		const typename ObjFileT<TIndex>::VertexGroup& vg,
 		std::vector<uint32_t>& unifiedIndices,
 		std::vector<Vector3>& unifiedPositions,
 		std::vector<Vector3>& unifiedNormals,
 		std::vector<Vector2>& unifiedUvs)
+{
+	VertexGroupScratch scratch;
+	ObjVertexGroupBuffers(objFile, vg, unifiedIndices, unifiedPositions, unifiedNormals, unifiedUvs, scratch);
+}
+
+template<typename TIndex>
+void ObjVertexGroupBuffers(
+		const ObjFileT<TIndex>& objFile,
+		const typename ObjFileT<TIndex>::VertexGroup& vg,
+		std::vector<uint32_t>& unifiedIndices,
+		std::vector<Vector3>& unifiedPositions,
+		std::vector<Vector3>& unifiedNormals,
+		std::vector<Vector2>& unifiedUvs,
+		VertexGroupScratch& scratch)
 {
 	unsigned int endQuad = vg.firstQuad + vg.numQuads;
 	unsigned int endTriangle = vg.firstTriangle + vg.numTriangles;
@@ -53,35 +279,37 @@ void ObjVertexGroupBuffers(
 	assert(endTriangle <= objFile.GetTriangles().size());
 	auto quadsBegin = objFile.GetQuads().begin();
 	auto trianglesBegin = objFile.GetTriangles().begin();
-	QuadRange quads(quadsBegin + vg.firstQuad, quadsBegin + endQuad);
-	TriangleRange triangles(trianglesBegin + vg.firstTriangle, trianglesBegin + endTriangle);
-
-	std::vector<uint32_t> positionIndices, normalIndices, uvIndices;
+	QuadRangeT<TIndex> quads(quadsBegin + vg.firstQuad, quadsBegin + endQuad);
+	TriangleRangeT<TIndex> triangles(trianglesBegin + vg.firstTriangle, trianglesBegin + endTriangle);
 
-	{
-		std::vector<uint32_t> quadPositionIndices;
-		for(auto& quad: quads)
-			quadPositionIndices.insert(quadPositionIndices.end(), quad.vertexIndices.begin(), quad.vertexIndices.end());
-		positionIndices.resize(quadPositionIndices.size() / 2 * 3);
-		MeshUtils::QuadToTriangleIndices(vg.numQuads, quadPositionIndices.data(), positionIndices.data());
-	}
+	// Quads are split into triangles the same way as MeshUtils::QuadToTriangleIndices does:
+	static const int kQuadTriangleCorners[6] = {0, 1, 2, 0, 2, 3};
+	const size_t numIndices = size_t(vg.numQuads) * 6 + size_t(vg.numTriangles) * 3;
+	if(numIndices == 0)
+		return;
 
+	std::vector<uint32_t>& positionIndices = scratch.positionIndices;
+	std::vector<uint32_t>& normalIndices = scratch.normalIndices;
+	std::vector<uint32_t>& uvIndices = scratch.uvIndices;
+	positionIndices.clear();
+	normalIndices.clear();
+	uvIndices.clear();
+	positionIndices.reserve(numIndices);
 	if(vg.hasNormals)
-	{
-		std::vector<uint32_t> quadNormalIndices;
-		for(auto& quad: quads)
-			quadNormalIndices.insert(quadNormalIndices.end(), quad.normalIndices.begin(), quad.normalIndices.end());
-		normalIndices.resize(quadNormalIndices.size() / 2 * 3);
-		MeshUtils::QuadToTriangleIndices(vg.numQuads, quadNormalIndices.data(), normalIndices.data());
-	}
-
+		normalIndices.reserve(numIndices);
 	if(vg.hasTexCoords)
+		uvIndices.reserve(numIndices);
+
+	for(auto& quad: quads)
 	{
-		std::vector<uint32_t> quadUvIndices;
-		for(auto& quad: quads)
-			quadUvIndices.insert(quadUvIndices.end(), quad.texCoordIndices.begin(), quad.texCoordIndices.end());
-		uvIndices.resize(quadUvIndices.size() / 2 * 3);
-		MeshUtils::QuadToTriangleIndices(vg.numQuads, quadUvIndices.data(), uvIndices.data());
+		for(int corner: kQuadTriangleCorners)
+		{
+			positionIndices.push_back(quad.vertexIndices[corner]);
+			if(vg.hasNormals)
+				normalIndices.push_back(quad.normalIndices[corner]);
+			if(vg.hasTexCoords)
+				uvIndices.push_back(quad.texCoordIndices[corner]);
+		}
 	}
 
 	for(auto& tri: triangles)
@@ -122,7 +350,124 @@ void ObjVertexGroupBuffers(
 				unifiedIndices,
 				unifiedPositions,
 				unifiedNormals,
-				unifiedUvs);
+				unifiedUvs,
+				scratch.unify);
+}
+
+template void ObjVertexGroupBuffers<uint16_t>(
+		const ObjFile& objFile,
+		const ObjFile::VertexGroup& vg,
+		std::vector<uint32_t>& unifiedIndices,
+		std::vector<Vector3>& unifiedPositions,
+		std::vector<Vector3>& unifiedNormals,
+		std::vector<Vector2>& unifiedUvs);
+
+template void ObjVertexGroupBuffers<uint32_t>(
+		const ObjFile32& objFile,
+		const ObjFile32::VertexGroup& vg,
+		std::vector<uint32_t>& unifiedIndices,
+		std::vector<Vector3>& unifiedPositions,
+		std::vector<Vector3>& unifiedNormals,
+		std::vector<Vector2>& unifiedUvs);
+
+template void ObjVertexGroupBuffers<uint16_t>(
+		const ObjFile& objFile,
+		const ObjFile::VertexGroup& vg,
+		std::vector<uint32_t>& unifiedIndices,
+		std::vector<Vector3>& unifiedPositions,
+		std::vector<Vector3>& unifiedNormals,
+		std::vector<Vector2>& unifiedUvs,
+		VertexGroupScratch& scratch);
+
+template void ObjVertexGroupBuffers<uint32_t>(
+		const ObjFile32& objFile,
+		const ObjFile32::VertexGroup& vg,
+		std::vector<uint32_t>& unifiedIndices,
+		std::vector<Vector3>& unifiedPositions,
+		std::vector<Vector3>& unifiedNormals,
+		std::vector<Vector2>& unifiedUvs,
+		VertexGroupScratch& scratch);
+
+template<typename TIndex>
+MeshSet ObjToMeshSet(const ObjFileT<TIndex>& objFile)
+{
+	MeshSet meshes;
+	meshes.reserve(objFile.GetVertexGroups().size());
+	VertexGroupScratch scratch;
+	for(auto& group: objFile.GetVertexGroups())
+		meshes.push_back(VertexGroupMesh(objFile, group, scratch));
+	return meshes;
+}
+
+template<typename TIndex>
+MeshSet ObjToMeshSet(const ObjFileT<TIndex>& objFile, TaskDispatcher& dispatcher)
+{
+	auto& groups = objFile.GetVertexGroups();
+	std::vector<std::optional<Mesh>> results(groups.size());
+
+	// One task per thread, each fetching groups until all are done:
+	const size_t numWorkers = std::min<size_t>(groups.size(), std::max(1u, std::thread::hardware_concurrency()));
+	std::atomic<size_t> nextGroup(0);
+	ParallelFor(dispatcher, numWorkers, [&](size_t)
+	{
+		VertexGroupScratch scratch;
+		for(size_t i = nextGroup++; i < groups.size(); i = nextGroup++)
+			results[i].emplace(VertexGroupMesh(objFile, groups[i], scratch));
+	});
+
+	MeshSet meshes;
+	meshes.reserve(results.size());
+	for(auto& mesh: results)
+		meshes.push_back(std::move(*mesh));
+	return meshes;
+}
+
+template MeshSet ObjToMeshSet<uint16_t>(const ObjFile& objFile);
+template MeshSet ObjToMeshSet<uint32_t>(const ObjFile32& objFile);
+template MeshSet ObjToMeshSet<uint16_t>(const ObjFile& objFile, TaskDispatcher& dispatcher);
+template MeshSet ObjToMeshSet<uint32_t>(const ObjFile32& objFile, TaskDispatcher& dispatcher);
+
+void StreamMeshes(TextReadStreamBase& stream, const MeshCallback& callback, float scale)
+{
+	ObjTokenizer tokenizer;
+	MeshStreamer streamer(callback, scale);
+	const char* line;
+	while((line = stream.GetNextLine()))
+		tokenizer.ParseLine(line, streamer);
+	streamer.Finish();
+}
+
+void StreamMeshes(std::string_view text, const MeshCallback& callback, float scale)
+{
+	ObjTokenizer tokenizer;
+	MeshStreamer streamer(callback, scale);
+	TextLineReader lines(text);
+	std::string_view line;
+	while(lines.GetNextLine(line))
+		tokenizer.ParseLine(line, streamer);
+	streamer.Finish();
+}
+
+bool RequiresWideIndices(std::string_view text)
+{
+	// Index 0xffff marks missing texture coordinates and normals:
+	const size_t kMaxCount = std::numeric_limits<uint16_t>::max();
+
+	size_t numVertices = 0, numTexCoords = 0, numNormals = 0;
+	TextLineReader lines(text);
+	std::string_view line;
+	while(lines.GetNextLine(line))
+	{
+		if(line.size() < 2 || line[0] != 'v')
+			continue;
+		if(line[1] == ' ')
+			numVertices++;
+		else if(line[1] == 't')
+			numTexCoords++;
+		else if(line[1] == 'n')
+			numNormals++;
+	}
+	return numVertices > kMaxCount || numTexCoords > kMaxCount || numNormals > kMaxCount;
 }
 
 }
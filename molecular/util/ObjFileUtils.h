@@ -29,6 +29,11 @@ SOFTWARE.
 #include <molecular/util/Range.h>
 #include <molecular/util/Vector3.h>
 #include <molecular/util/ObjFile.h>
+#include <molecular/util/Mesh.h>
+#include <molecular/util/MeshUtils.h>
+#include <molecular/util/TaskDispatcher.h>
+
+#include <functional>
 
 namespace molecular
 {
@@ -37,19 +42,102 @@ namespace util
 namespace ObjFileUtils
 {
 
-using QuadRange = Range<std::vector<ObjFile::Quad>::const_iterator>;
-using TriangleRange = Range<std::vector<ObjFile::Triangle>::const_iterator>;
+template<typename TIndex>
+using QuadRangeT = Range<typename std::vector<typename ObjFileT<TIndex>::Quad>::const_iterator>;
+
+template<typename TIndex>
+using TriangleRangeT = Range<typename std::vector<typename ObjFileT<TIndex>::Triangle>::const_iterator>;
+
+using QuadRange = QuadRangeT<uint16_t>;
+using TriangleRange = TriangleRangeT<uint16_t>;
 
 /// Convert OBJ mesh data to data for three vertex buffers and one index buffer
-/** Index and vertex data is appended to the output vectors. */
+/** Index and vertex data is appended to the output vectors. Quads are split
+	into two triangles. Parse with ObjPolygonMode::kTriangulate to also get
+	polygons with more than four vertices. */
+template<typename TIndex>
 void ObjVertexGroupBuffers(
-		const ObjFile& objFile,
-		const ObjFile::VertexGroup& vg,
+		const ObjFileT<TIndex>& objFile,
+		const typename ObjFileT<TIndex>::VertexGroup& vg,
 		std::vector<uint32_t>& unifiedIndices,
 		std::vector<Vector3>& unifiedPositions,
 		std::vector<Vector3>& unifiedNormals,
 		std::vector<Vector2>& unifiedUvs);
 
+/// Reusable memory for ObjVertexGroupBuffers()
+/** Not thread-safe, use one instance per thread. */
+struct VertexGroupScratch
+{
+	std::vector<uint32_t> positionIndices;
+	std::vector<uint32_t> normalIndices;
+	std::vector<uint32_t> uvIndices;
+	MeshUtils::UnifiedIndicesScratch unify;
+};
+
+/// Convert OBJ mesh data to data for three vertex buffers and one index buffer
+/** This is an overloaded function. Reuses scratch memory across calls. */
+template<typename TIndex>
+void ObjVertexGroupBuffers(
+		const ObjFileT<TIndex>& objFile,
+		const typename ObjFileT<TIndex>::VertexGroup& vg,
+		std::vector<uint32_t>& unifiedIndices,
+		std::vector<Vector3>& unifiedPositions,
+		std::vector<Vector3>& unifiedNormals,
+		std::vector<Vector2>& unifiedUvs,
+		VertexGroupScratch& scratch);
+
+/// Convert all vertex groups to meshes
+/** Element i of the result corresponds to GetVertexGroups()[i]. Meshes
+	contain kPosition, kNormal and kTextureCoords as far as the group has
+	them, unified triangle indices and the group's material. */
+template<typename TIndex>
+MeshSet ObjToMeshSet(const ObjFileT<TIndex>& objFile);
+
+/// Convert all vertex groups to meshes using multiple threads
+/** Groups are processed concurrently, each worker reusing its scratch
+	memory. The result is identical to the single-threaded version. */
+template<typename TIndex>
+MeshSet ObjToMeshSet(const ObjFileT<TIndex>& objFile, TaskDispatcher& dispatcher);
+
+/// Receives meshes from StreamMeshes()
+/** @param name Name of the vertex group. */
+using MeshCallback = std::function<void (const std::string& name, Mesh&& mesh)>;
+
+/// Convert OBJ text to meshes while reading it
+/** Emits a Mesh with unified indices for each vertex group as soon as the group
+	is closed by a g, o or usemtl statement, or by the end of the text. Vertex
+	groups are formed the same way as in ObjFile. Only the vertex attribute
+	lists of the file and the faces of the current group are kept in memory,
+	so peak memory stays far below that of ObjFile followed by
+	ObjVertexGroupBuffers().
+
+	Polygons are fan-triangulated. Meshes contain kPosition, and kNormal and
+	kTextureCoords if all faces of the group reference them. Groups without
+	faces are skipped. */
+void StreamMeshes(TextReadStreamBase& stream, const MeshCallback& callback, float scale = 1.0f);
+
+/// Convert OBJ text in memory to meshes while reading it
+/** @see StreamMeshes(TextReadStreamBase&, const MeshCallback&, float) */
+void StreamMeshes(std::string_view text, const MeshCallback& callback, float scale = 1.0f);
+
+/// Check if ObjFile32 is required to load the text
+/** Counts vertex, texture coordinate and normal statements without parsing
+	them. Malformed lines are counted as well, so the result errs on the side
+	of wide indices.
+	@returns true if any of the lists has more entries than 16 bit indices can address. */
+bool RequiresWideIndices(std::string_view text);
+
+/// Parse text into an ObjFile with the smallest sufficient index type
+/** Calls function with either an ObjFile or an ObjFile32. */
+template<class TFunction>
+void ParseWithFittingIndexType(std::string_view text, TFunction function, float scale = 1.0f, ObjPolygonMode polygonMode = ObjPolygonMode::kQuads)
+{
+	if(RequiresWideIndices(text))
+		function(ObjFile32(text, scale, polygonMode));
+	else
+		function(ObjFile(text, scale, polygonMode));
+}
+
 }
 }
 }
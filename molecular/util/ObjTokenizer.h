@@ -0,0 +1,316 @@
+/*	ObjTokenizer.h
+
+MIT License
+
+Copyright (c) 2026 Fabian Herb
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef MOLECULAR_UTIL_OBJTOKENIZER_H
+#define MOLECULAR_UTIL_OBJTOKENIZER_H
+
+#include <molecular/util/StringUtils.h>
+#include <molecular/util/Vector3.h>
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace molecular
+{
+namespace util
+{
+
+/// Splits lines of Wavefront OBJ files into their components
+/** Parses each line in a single pass directly from the line buffer. There is no
+	format string interpretation and no dependency on the current locale. The
+	parsed contents are reported to an actor, similar to Parser::Action. */
+class ObjTokenizer
+{
+public:
+	/// Corner of a face as written in the file
+	/** Indices are 1-based as in the file. Negative values are relative to the
+		end of the respective list. Zero means the index is not present. */
+	struct FaceVertex
+	{
+		int32_t vertex;
+		int32_t texCoord;
+		int32_t normal;
+	};
+
+	/// Index layout of a face line
+	enum class FaceFormat
+	{
+		kPositions, ///< f v v v
+		kPositionsTexCoords, ///< f v/t v/t v/t
+		kPositionsTexCoordsNormals, ///< f v/t/n v/t/n v/t/n
+		kPositionsNormals ///< f v//n v//n v//n
+	};
+
+	static bool HasTexCoords(FaceFormat format)
+	{
+		return format == FaceFormat::kPositionsTexCoords || format == FaceFormat::kPositionsTexCoordsNormals;
+	}
+
+	static bool HasNormals(FaceFormat format)
+	{
+		return format == FaceFormat::kPositionsNormals || format == FaceFormat::kPositionsTexCoordsNormals;
+	}
+
+	/// Tokenize a single line and report its contents to the actor
+	/** The actor has to provide the following methods:
+		- Vertex(const Vector3&)
+		- TexCoord(const Vector2&)
+		- Normal(const Vector3&)
+		- Face(const FaceVertex vertices[], size_t count, FaceFormat format)
+		- Group(std::string_view name)
+		- Object(std::string_view name)
+		- UseMaterial(std::string_view name)
+		- MaterialLibrary(std::string_view file)
+
+		Face() is also called for malformed face lines, with count being less than three.
+		@param line Line contents without the terminating newline character. */
+	template<class Actor>
+	void ParseLine(std::string_view line, Actor& actor);
+
+	/// Parse signed decimal integer
+	/** @see StringUtils::ParseNumber()
+		@returns false if there is no integer at it. it is left unchanged in that case. */
+	static bool ParseInt(const char*& it, const char* end, int32_t& out);
+
+	/// Parse decimal floating point number
+	/** Correctly rounded. @see StringUtils::ParseNumber()
+		@returns false if there is no number at it. it is left unchanged in that case. */
+	static bool ParseFloat(const char*& it, const char* end, float& out);
+
+private:
+	static bool IsSpace(char c) {return c == ' ' || c == '\t';}
+
+	static const char* SkipSpace(const char* it, const char* end)
+	{
+		while(it != end && IsSpace(*it))
+			++it;
+		return it;
+	}
+
+	/// Parse count whitespace-separated floats
+	static bool ParseFloats(const char* it, const char* end, float out[], int count);
+
+	/// Parse the first corner of a face, which determines the format of the rest
+	static bool ParseFirstFaceVertex(const char*& it, const char* end, FaceFormat& format, FaceVertex& out);
+
+	/// Parse a face corner of the given format
+	static bool ParseFaceVertex(const char*& it, const char* end, FaceFormat format, FaceVertex& out);
+
+	/// Remainder of the line after a keyword
+	static std::string_view Argument(std::string_view line, size_t offset)
+	{
+		return line.size() > offset ? line.substr(offset) : std::string_view();
+	}
+
+	template<class Actor>
+	void ParseFace(const char* it, const char* end, Actor& actor);
+
+	/// Reused for every face line to avoid allocations
+	std::vector<FaceVertex> mFaceVertices;
+};
+
+/*****************************************************************************/
+
+template<class Actor>
+void ObjTokenizer::ParseLine(std::string_view line, Actor& actor)
+{
+	if(!line.empty() && line.back() == '\r')
+		line.remove_suffix(1);
+
+	if(line.empty() || line[0] == '#')
+		return; // Skip empty lines and comments
+
+	const char* it = line.data();
+	const char* end = it + line.size();
+
+	switch(line[0])
+	{
+	case 'v':
+		if(line.size() < 2)
+			return;
+		if(line[1] == ' ')
+		{
+			Vector3 v;
+			if(ParseFloats(it + 2, end, &v[0], 3))
+				actor.Vertex(v);
+		}
+		else if(line[1] == 't')
+		{
+			float uv[2];
+			if(ParseFloats(it + 2, end, uv, 2))
+				actor.TexCoord(Vector2(uv[0], uv[1]));
+		}
+		else if(line[1] == 'n')
+		{
+			Vector3 n;
+			if(ParseFloats(it + 2, end, &n[0], 3))
+				actor.Normal(n);
+		}
+		break;
+
+	case 'g':
+		actor.Group(Argument(line, 2));
+		break;
+
+	case 'f':
+		ParseFace(it + 1, end, actor);
+		break;
+
+	case 'o':
+		actor.Object(Argument(line, 2));
+		break;
+
+	default:
+		if(line.compare(0, 6, "usemtl") == 0)
+			actor.UseMaterial(Argument(line, 7));
+		else if(line.compare(0, 6, "mtllib") == 0)
+			actor.MaterialLibrary(Argument(line, 7));
+	}
+}
+
+template<class Actor>
+void ObjTokenizer::ParseFace(const char* it, const char* end, Actor& actor)
+{
+	mFaceVertices.clear();
+	FaceFormat format = FaceFormat::kPositions;
+	FaceVertex vertex;
+
+	it = SkipSpace(it, end);
+	if(ParseFirstFaceVertex(it, end, format, vertex))
+	{
+		mFaceVertices.push_back(vertex);
+		while(true)
+		{
+			// Corners must be separated by whitespace:
+			const char* next = SkipSpace(it, end);
+			if(next == it || next == end)
+				break;
+			it = next;
+			if(!ParseFaceVertex(it, end, format, vertex))
+				break;
+			mFaceVertices.push_back(vertex);
+		}
+	}
+	actor.Face(mFaceVertices.data(), mFaceVertices.size(), format);
+}
+
+inline bool ObjTokenizer::ParseInt(const char*& it, const char* end, int32_t& out)
+{
+	return StringUtils::ParseNumber(it, end, out);
+}
+
+inline bool ObjTokenizer::ParseFloat(const char*& it, const char* end, float& out)
+{
+	return StringUtils::ParseNumber(it, end, out);
+}
+
+inline bool ObjTokenizer::ParseFloats(const char* it, const char* end, float out[], int count)
+{
+	for(int i = 0; i < count; ++i)
+	{
+		it = SkipSpace(it, end);
+		if(!ParseFloat(it, end, out[i]))
+			return false;
+	}
+	return true;
+}
+
+inline bool ObjTokenizer::ParseFirstFaceVertex(const char*& it, const char* end, FaceFormat& format, FaceVertex& out)
+{
+	const char* p = it;
+	out = FaceVertex{0, 0, 0};
+	if(!ParseInt(p, end, out.vertex))
+		return false;
+
+	format = FaceFormat::kPositions;
+	if(p != end && *p == '/')
+	{
+		++p;
+		if(p != end && *p == '/')
+		{
+			++p;
+			if(!ParseInt(p, end, out.normal))
+				return false;
+			format = FaceFormat::kPositionsNormals;
+		}
+		else
+		{
+			if(!ParseInt(p, end, out.texCoord))
+				return false;
+			format = FaceFormat::kPositionsTexCoords;
+			if(p != end && *p == '/')
+			{
+				++p;
+				if(!ParseInt(p, end, out.normal))
+					return false;
+				format = FaceFormat::kPositionsTexCoordsNormals;
+			}
+		}
+	}
+	it = p;
+	return true;
+}
+
+inline bool ObjTokenizer::ParseFaceVertex(const char*& it, const char* end, FaceFormat format, FaceVertex& out)
+{
+	const char* p = it;
+	out = FaceVertex{0, 0, 0};
+	if(!ParseInt(p, end, out.vertex))
+		return false;
+
+	switch(format)
+	{
+	case FaceFormat::kPositions:
+		break;
+
+	case FaceFormat::kPositionsTexCoords:
+		if(p == end || *p++ != '/' || !ParseInt(p, end, out.texCoord))
+			return false;
+		break;
+
+	case FaceFormat::kPositionsTexCoordsNormals:
+		if(p == end || *p++ != '/' || !ParseInt(p, end, out.texCoord))
+			return false;
+		if(p == end || *p++ != '/' || !ParseInt(p, end, out.normal))
+			return false;
+		break;
+
+	case FaceFormat::kPositionsNormals:
+		if(end - p < 2 || p[0] != '/' || p[1] != '/')
+			return false;
+		p += 2;
+		if(!ParseInt(p, end, out.normal))
+			return false;
+		break;
+	}
+	it = p;
+	return true;
+}
+
+}
+} // namespace molecular
+
+#endif // MOLECULAR_UTIL_OBJTOKENIZER_H
@@ -0,0 +1,81 @@
+/*	ParallelFor.h
+
+MIT License
+
+Copyright (c) 2026 Fabian Herb
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef MOLECULAR_UTIL_PARALLELFOR_H
+#define MOLECULAR_UTIL_PARALLELFOR_H
+
+#include <cstddef>
+#include <exception>
+#include <mutex>
+
+namespace molecular
+{
+namespace util
+{
+
+/// Call function(i) for each i in [0, count) on a TaskDispatcher and wait for completion
+/** The calling thread helps processing the tasks while waiting. If one or more
+	invocations throw, the first exception caught is rethrown in the calling thread
+	after all tasks have finished. */
+template<class TDispatcher, class TFunction>
+void ParallelFor(TDispatcher& dispatcher, size_t count, TFunction function)
+{
+	if(count == 0)
+		return;
+	if(count == 1)
+	{
+		function(size_t(0));
+		return;
+	}
+
+	std::mutex exceptionMutex;
+	std::exception_ptr exception;
+	typename TDispatcher::FinishFlag flag;
+	for(size_t i = 0; i < count; ++i)
+	{
+		dispatcher.EnqueueTask([&, i]()
+		{
+			try
+			{
+				function(i);
+			}
+			catch(...)
+			{
+				std::lock_guard<std::mutex> lock(exceptionMutex);
+				if(!exception)
+					exception = std::current_exception();
+			}
+		}, flag);
+	}
+	dispatcher.WaitUntilFinished(flag);
+
+	if(exception)
+		std::rethrow_exception(exception);
+}
+
+}
+} // namespace molecular
+
+#endif // MOLECULAR_UTIL_PARALLELFOR_H
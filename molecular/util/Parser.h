@@ -26,7 +26,10 @@ SOFTWARE.
 #ifndef MOLECULAR_PARSER_H
 #define MOLECULAR_PARSER_H
 
+#include <molecular/util/StringUtils.h>
+
 #include <cctype>
+#include <iterator>
 
 namespace molecular
 {
@@ -270,6 +273,35 @@ typedef Concatenation<Option<Char<'-'> >, UnsignedInteger> Integer;
 /// Match signed real number
 typedef Concatenation<Integer, Option<Concatenation<Char<'.'>, UnsignedInteger> >, Option<Concatenation<Char<'e'>, Integer> > > Real;
 
+/// Match signed real number and pass its value to the actor
+/** Matches the same input as Real. Calls actor->ParserValue(action, value)
+	with the value converted by StringUtils::ParseNumber(), which is correctly
+	rounded and independent of the current locale. Requires contiguous
+	character iterators.
+	@tparam T float or double. */
+template<int action, typename T = double>
+class RealValue
+{
+public:
+	template<class Iterator, class Actor>
+	static bool Parse(Iterator& begin, Iterator end, Actor* actor)
+	{
+		Iterator oldBegin = begin;
+		if(!Real::Parse(begin, end, actor))
+			return false;
+
+		if(actor)
+		{
+			const char* first = &*oldBegin;
+			const char* last = first + std::distance(oldBegin, begin);
+			T value = 0;
+			StringUtils::ParseNumber(first, last, value);
+			actor->ParserValue(action, value);
+		}
+		return true;
+	}
+};
+
 } // namespace Parser
 } // namespace util
 } // namespace molecular
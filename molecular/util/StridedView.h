@@ -0,0 +1,130 @@
+/*	StridedView.h
+
+MIT License
+
+Copyright (c) 2026 Fabian Herb
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef MOLECULAR_STRIDEDVIEW_H
+#define MOLECULAR_STRIDEDVIEW_H
+
+#include <molecular/util/BufferInfo.h>
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+
+namespace molecular
+{
+namespace util
+{
+
+/// Typed view of elements that are spaced at a fixed distance in memory
+/** Does not own the data. Gives access to a single attribute of interleaved or
+	memory mapped vertex buffers without copying. Use a const T for read-only views.
+	@see Range */
+template<class T>
+class StridedView
+{
+	using Byte = typename std::conditional<std::is_const<T>::value, const uint8_t, uint8_t>::type;
+
+public:
+	/// Forward iterator over the elements of a StridedView
+	class Iterator
+	{
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = typename std::remove_const<T>::type;
+		using difference_type = std::ptrdiff_t;
+		using pointer = T*;
+		using reference = T&;
+
+		Iterator(Byte* pointer, size_t stride) : mPointer(pointer), mStride(stride) {}
+
+		T& operator*() const {return *reinterpret_cast<T*>(mPointer);}
+		T* operator->() const {return reinterpret_cast<T*>(mPointer);}
+		Iterator& operator++() {mPointer += mStride; return *this;}
+		Iterator operator++(int) {Iterator old = *this; mPointer += mStride; return old;}
+		bool operator==(const Iterator& other) const {return mPointer == other.mPointer;}
+		bool operator!=(const Iterator& other) const {return mPointer != other.mPointer;}
+
+	private:
+		Byte* mPointer;
+		size_t mStride;
+	};
+
+	/// Construct empty view
+	StridedView() : mData(nullptr), mCount(0), mStride(sizeof(T)) {}
+
+	/// Construct from pointer to the first element
+	/** @param stride Distance between elements in bytes. */
+	StridedView(T* data, size_t count, size_t stride = sizeof(T)) :
+		mData(reinterpret_cast<Byte*>(data)), mCount(count), mStride(stride)
+	{}
+
+	/// Construct from buffer base pointer and attribute layout
+	/** @param buffer Start of the buffer referenced by info.buffer.
+		@param count Number of vertices. */
+	StridedView(Byte* buffer, const VertexAttributeInfo& info, size_t count) :
+		mData(buffer + info.offset),
+		mCount(count),
+		mStride(info.stride ? info.stride : sizeof(T))
+	{
+		assert(VertexAttributeInfo::GetTypeSize(info.type) * info.components == sizeof(T));
+	}
+
+	/// Read-only view of the same data
+	operator StridedView<const T>() const
+	{
+		return StridedView<const T>(reinterpret_cast<const T*>(mData), mCount, mStride);
+	}
+
+	T& operator[](size_t index) const
+	{
+		assert(index < mCount);
+		return *reinterpret_cast<T*>(mData + index * mStride);
+	}
+
+	size_t size() const {return mCount;}
+	bool empty() const {return mCount == 0;}
+	size_t GetStride() const {return mStride;}
+
+	Iterator begin() const {return Iterator(mData, mStride);}
+	Iterator end() const {return Iterator(mData + mCount * mStride, mStride);}
+
+private:
+	Byte* mData;
+	size_t mCount;
+	size_t mStride;
+};
+
+template<class T>
+StridedView<T> MakeStridedView(T* data, size_t count, size_t stride = sizeof(T))
+{
+	return StridedView<T>(data, count, stride);
+}
+
+}
+} // namespace molecular
+
+#endif // MOLECULAR_STRIDEDVIEW_H
@@ -25,9 +25,14 @@ SOFTWARE.
 
 #include "StringUtils.h"
 
+#include <algorithm>
+#include <charconv>
+#include <cmath>
 #include <cstdarg>
 #include <cstdio>
 #include <cstring>
+#include <limits>
+#include <type_traits>
 
 #ifndef _MSC_VER
 #include <libgen.h>
@@ -58,6 +63,152 @@ int ScanF(const char* string, const char* format, ...)
 	return result;
 }
 
+namespace
+{
+
+/// Strip a leading '+', which std::from_chars does not accept
+/** @returns Pointer to the first character after the sign. */
+const char* SkipPlus(const char* it, const char* end)
+{
+	if(it != end && *it == '+' && it + 1 != end && *(it + 1) != '-' && *(it + 1) != '+')
+		return it + 1;
+	return it;
+}
+
+#if !defined(__cpp_lib_to_chars)
+/// Fallback for standard libraries without floating point std::from_chars
+/** Exact for up to 15 significant digits and decimal exponents up to 22.
+	Does not parse "inf" and "nan". */
+template<typename T>
+std::from_chars_result FromCharsFallback(const char* first, const char* last, T& out)
+{
+	static const double kPowersOf10[] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+	auto isDigit = [](char c) {return c >= '0' && c <= '9';};
+
+	const char* p = first;
+	const bool negative = (p != last && *p == '-');
+	if(negative)
+		++p;
+
+	// Collect up to 19 significant digits, which always fit into 64 bits:
+	uint64_t mantissa = 0;
+	int significantDigits = 0;
+	int exponent = 0;
+	bool hasDigits = false;
+	for(; p != last && isDigit(*p); ++p)
+	{
+		hasDigits = true;
+		if(significantDigits < 19)
+		{
+			mantissa = mantissa * 10 + (*p - '0');
+			if(mantissa)
+				significantDigits++;
+		}
+		else
+			exponent++;
+	}
+	if(p != last && *p == '.')
+	{
+		for(++p; p != last && isDigit(*p); ++p)
+		{
+			hasDigits = true;
+			if(significantDigits < 19)
+			{
+				mantissa = mantissa * 10 + (*p - '0');
+				if(mantissa)
+					significantDigits++;
+				exponent--;
+			}
+		}
+	}
+	if(!hasDigits)
+		return {first, std::errc::invalid_argument};
+
+	if(p != last && (*p == 'e' || *p == 'E'))
+	{
+		int32_t explicitExponent = 0;
+		const char* exponentBegin = SkipPlus(p + 1, last);
+		auto result = std::from_chars(exponentBegin, last, explicitExponent);
+		if(result.ec == std::errc())
+		{
+			exponent += explicitExponent;
+			p = result.ptr;
+		}
+	}
+
+	double value = double(mantissa);
+	if(exponent < 0)
+		value = (exponent >= -22) ? value / kPowersOf10[-exponent] : value * std::pow(10.0, exponent);
+	else if(exponent > 0)
+		value = (exponent <= 22) ? value * kPowersOf10[exponent] : value * std::pow(10.0, exponent);
+
+	out = T(negative ? -value : value);
+	return {p, std::errc()};
+}
+#endif
+
+template<typename T>
+std::from_chars_result FromChars(const char* first, const char* last, T& out)
+{
+#if !defined(__cpp_lib_to_chars)
+	if constexpr(std::is_floating_point<T>::value)
+		return FromCharsFallback(first, last, out);
+	else
+#endif
+	return std::from_chars(first, last, out);
+}
+
+template<typename T>
+bool ParseNumberImpl(const char*& it, const char* end, T& out)
+{
+	const char* first = SkipPlus(it, end);
+	auto result = FromChars(first, end, out);
+	if constexpr(std::is_floating_point<T>::value)
+	{
+		if(result.ec == std::errc::result_out_of_range)
+		{
+			// Consume out of range values like strtod does, yielding zero or infinity:
+			double wide = 0;
+			bool overflow;
+			if(FromChars(first, result.ptr, wide).ec == std::errc())
+				overflow = std::abs(wide) > 1;
+			else
+			{
+				const char* e = std::find_if(first, result.ptr, [](char c){return c == 'e' || c == 'E';});
+				overflow = (e == result.ptr || e + 1 == result.ptr || *(e + 1) != '-');
+			}
+			const T magnitude = overflow ? std::numeric_limits<T>::infinity() : T(0);
+			out = (*first == '-') ? -magnitude : magnitude;
+			it = result.ptr;
+			return true;
+		}
+	}
+	if(result.ec != std::errc())
+		return false;
+	it = result.ptr;
+	return true;
+}
+
+}
+
+bool ParseNumber(const char*& it, const char* end, float& out)
+{
+	return ParseNumberImpl(it, end, out);
+}
+
+bool ParseNumber(const char*& it, const char* end, double& out)
+{
+	return ParseNumberImpl(it, end, out);
+}
+
+bool ParseNumber(const char*& it, const char* end, int32_t& out)
+{
+	return ParseNumberImpl(it, end, out);
+}
+
 bool EndsWith(const char* haystack, const char* needle)
 {
 	size_t haystackLength = strlen(haystack);
@@ -28,6 +28,7 @@ SOFTWARE.
 
 #include <string>
 #include <vector>
+#include <cstdint>
 #include <cstring>
 
 namespace molecular
@@ -41,6 +42,24 @@ namespace StringUtils
 /// Wrapper for sscanf that ignores the current locale
 int ScanF(const char* string, const char* format, ...);
 
+/// Parse a decimal floating point number without regard to the current locale
+/** Accepts an optional sign, digits with an optional decimal point and an
+	optional exponent, as well as "inf" and "nan". The result is correctly
+	rounded. Leading whitespace is not skipped.
+	@returns false if there is no number at it. it is left unchanged in that
+		case, otherwise it points behind the number. */
+bool ParseNumber(const char*& it, const char* end, float& out);
+
+/// Parse a decimal floating point number without regard to the current locale
+/** This is an overloaded function. */
+bool ParseNumber(const char*& it, const char* end, double& out);
+
+/// Parse a signed decimal integer
+/** Accepts an optional sign. Fails on overflow.
+	@returns false if there is no integer at it. it is left unchanged in that
+		case, otherwise it points behind the number. */
+bool ParseNumber(const char*& it, const char* end, int32_t& out);
+
 /// Returns true if haystack ends with needle
 bool EndsWith(const char* haystack, const char* needle);
 
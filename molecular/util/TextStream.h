@@ -28,6 +28,8 @@ SOFTWARE.
 
 #include <stdexcept>
 #include <stdint.h>
+#include <cstring>
+#include <string_view>
 
 namespace molecular
 {
@@ -82,6 +84,37 @@ private:
 	Storage& mStorage;
 };
 
+/// Splits text in memory into lines without copying
+/** Intended for memory-mapped files. Lines can have arbitrary length. */
+class TextLineReader
+{
+public:
+	explicit TextLineReader(std::string_view text) :
+		mCursor(text.data()),
+		mEnd(text.data() + text.size())
+	{}
+
+	/// Reads a line
+	/** @param line Receives a view into the text, without the newline
+			character. Valid as long as the underlying text.
+		@returns false if the text is at its end. */
+	bool GetNextLine(std::string_view& line)
+	{
+		if(mCursor == mEnd)
+			return false;
+
+		auto newline = static_cast<const char*>(std::memchr(mCursor, '\n', mEnd - mCursor));
+		const char* lineEnd = newline ? newline : mEnd;
+		line = std::string_view(mCursor, lineEnd - mCursor);
+		mCursor = newline ? newline + 1 : mEnd;
+		return true;
+	}
+
+private:
+	const char* mCursor;
+	const char* mEnd;
+};
+
 }
 } // namespace molecular
 
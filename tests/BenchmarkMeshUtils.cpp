@@ -0,0 +1,361 @@
+/*	BenchmarkMeshUtils.cpp
+
+MIT License
+
+Copyright (c) 2026 Fabian Herb
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <catch2/catch_test_macros.hpp>
+#include <molecular/util/MeshUtils.h>
+#include "MeshGenerators.h"
+#include <molecular/util/ObjFile.h>
+#include <molecular/util/ObjFileUtils.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <unordered_map>
+
+using namespace molecular::util;
+
+namespace
+{
+
+/// Separate index streams of a triangulated grid
+/** Positions and normals are shared between neighbouring quads, texture
+	coordinates are split at every tenth column like UV seams. */
+struct SeparateIndices
+{
+	explicit SeparateIndices(size_t numIndices)
+	{
+		const uint32_t size = 512;
+		for(uint32_t y = 0; positions.size() < numIndices; y = (y + 1) % size)
+		{
+			for(uint32_t x = 0; x < size && positions.size() < numIndices; ++x)
+			{
+				const uint32_t corners[6][2] = {{x, y}, {x + 1, y}, {x + 1, y + 1}, {x, y}, {x + 1, y + 1}, {x, y + 1}};
+				for(auto& corner: corners)
+				{
+					const uint32_t vertex = corner[1] * (size + 1) + corner[0];
+					positions.push_back(vertex);
+					normals.push_back(vertex);
+					uvs.push_back((corner[0] % 10 == 0 && corner[0] != x) ? vertex + (size + 1) * (size + 1) : vertex);
+				}
+			}
+		}
+		positions.resize(numIndices);
+		normals.resize(numIndices);
+		uvs.resize(numIndices);
+		numAttributes = 2 * (size + 1) * (size + 1);
+		positionData.resize(numAttributes);
+		normalData.resize(numAttributes);
+		uvData.resize(numAttributes);
+	}
+
+	/// Randomize triangle order, as in meshes without spatial locality
+	void Shuffle()
+	{
+		std::vector<size_t> order(positions.size() / 3);
+		for(size_t i = 0; i < order.size(); ++i)
+			order[i] = i;
+		std::shuffle(order.begin(), order.end(), std::mt19937(42));
+		for(auto* indices: {&positions, &normals, &uvs})
+		{
+			std::vector<uint32_t> shuffled;
+			shuffled.reserve(indices->size());
+			for(size_t triangle: order)
+				shuffled.insert(shuffled.end(), indices->begin() + triangle * 3, indices->begin() + triangle * 3 + 3);
+			*indices = std::move(shuffled);
+		}
+	}
+
+	std::vector<uint32_t> positions, normals, uvs;
+	size_t numAttributes;
+	std::vector<Vector3> positionData, normalData;
+	std::vector<Vector2> uvData;
+};
+
+/// SeparateToUnifiedIndices as implemented with std::unordered_map before
+template<class Attribute0, class Attribute1, class Attribute2>
+void UnorderedMapUnify(
+		size_t numIndices,
+		const uint32_t indices0[],
+		const uint32_t indices1[],
+		const uint32_t indices2[],
+		const Attribute0 attributes0[],
+		const Attribute1 attributes1[],
+		const Attribute2 attributes2[],
+		std::vector<uint32_t>& outIndices,
+		std::vector<Attribute0>& outAttributes0,
+		std::vector<Attribute1>& outAttributes1,
+		std::vector<Attribute2>& outAttributes2)
+{
+	std::unordered_map<uint64_t, uint32_t> vertexMap;
+	for(size_t i = 0; i < numIndices; ++i)
+	{
+		const uint64_t combinedIndex = (static_cast<uint64_t>(indices2[i]) << 42) | (static_cast<uint64_t>(indices1[i]) << 21) | indices0[i];
+		auto it = vertexMap.find(combinedIndex);
+		if(it == vertexMap.end())
+		{
+			uint32_t outIndex = outAttributes0.size();
+			vertexMap[combinedIndex] = outIndex;
+			outIndices.push_back(outIndex);
+			outAttributes0.push_back(attributes0[indices0[i]]);
+			outAttributes1.push_back(attributes1[indices1[i]]);
+			outAttributes2.push_back(attributes2[indices2[i]]);
+		}
+		else
+			outIndices.push_back(it->second);
+	}
+}
+
+/// UV sphere in OBJ format, with texture coordinates and normals
+std::string GenerateSphereObj(int rings, int segments)
+{
+	std::ostringstream out;
+	for(int ring = 0; ring <= rings; ++ring)
+	{
+		const float theta = 3.14159265f * ring / rings;
+		for(int segment = 0; segment <= segments; ++segment)
+		{
+			const float phi = 2 * 3.14159265f * segment / segments;
+			const float x = std::sin(theta) * std::cos(phi), y = std::sin(theta) * std::sin(phi), z = std::cos(theta);
+			out << "v " << x << ' ' << y << ' ' << z << '\n';
+			out << "vn " << x << ' ' << y << ' ' << z << '\n';
+			out << "vt " << float(segment) / segments << ' ' << float(ring) / rings << '\n';
+		}
+	}
+	out << "g sphere\n";
+	for(int ring = 0; ring < rings; ++ring)
+	{
+		for(int segment = 0; segment < segments; ++segment)
+		{
+			const int i = ring * (segments + 1) + segment + 1;
+			const int j = i + segments + 1;
+			out << "f " << i << '/' << i << '/' << i << ' ' << j << '/' << j << '/' << j << ' '
+				<< j + 1 << '/' << j + 1 << '/' << j + 1 << ' ' << i + 1 << '/' << i + 1 << '/' << i + 1 << '\n';
+		}
+	}
+	return out.str();
+}
+
+}
+
+TEST_CASE("BenchmarkSeparateToUnifiedIndices")
+{
+	const size_t kNumIndices = 1 << 20;
+	SeparateIndices in(kNumIndices);
+	SeparateIndices shuffled(kNumIndices);
+	shuffled.Shuffle();
+
+	for(auto input: {std::make_pair("", &in), std::make_pair("shuffled, ", &shuffled)})
+	{
+		const std::string prefix = input.first;
+		const SeparateIndices& data = *input.second;
+
+		BENCHMARK(prefix + "std::unordered_map, 3 attributes, 1M indices")
+		{
+			std::vector<uint32_t> indices;
+			std::vector<Vector3> positions, normals;
+			std::vector<Vector2> uvs;
+			UnorderedMapUnify(kNumIndices, data.positions.data(), data.normals.data(), data.uvs.data(),
+					data.positionData.data(), data.normalData.data(), data.uvData.data(),
+					indices, positions, normals, uvs);
+			return positions.size();
+		};
+
+		BENCHMARK(prefix + "SeparateToUnifiedIndices, 3 attributes, 1M indices")
+		{
+			std::vector<uint32_t> indices;
+			std::vector<Vector3> positions, normals;
+			std::vector<Vector2> uvs;
+			MeshUtils::SeparateToUnifiedIndices(kNumIndices, data.positions.data(), data.normals.data(), data.uvs.data(),
+					data.numAttributes, data.positionData.data(),
+					data.numAttributes, data.normalData.data(),
+					data.numAttributes, data.uvData.data(),
+					indices, positions, normals, uvs);
+			return positions.size();
+		};
+
+		MeshUtils::UnifiedIndicesScratch scratch;
+		BENCHMARK(prefix + "SeparateToUnifiedIndices with scratch, 3 attributes, 1M indices")
+		{
+			std::vector<uint32_t> indices;
+			std::vector<Vector3> positions, normals;
+			std::vector<Vector2> uvs;
+			MeshUtils::SeparateToUnifiedIndices(kNumIndices, data.positions.data(), data.normals.data(), data.uvs.data(),
+					data.numAttributes, data.positionData.data(),
+					data.numAttributes, data.normalData.data(),
+					data.numAttributes, data.uvData.data(),
+					indices, positions, normals, uvs, scratch);
+			return positions.size();
+		};
+
+		StdTaskQueue queue;
+		BENCHMARK(prefix + "SeparateToUnifiedIndices sorted, 3 attributes, 1M indices")
+		{
+			std::vector<uint32_t> indices;
+			std::vector<Vector3> positions, normals;
+			std::vector<Vector2> uvs;
+			MeshUtils::SeparateToUnifiedIndices(queue, kNumIndices, data.positions.data(), data.normals.data(), data.uvs.data(),
+					data.numAttributes, data.positionData.data(),
+					data.numAttributes, data.normalData.data(),
+					data.numAttributes, data.uvData.data(),
+					indices, positions, normals, uvs);
+			return positions.size();
+		};
+
+		BENCHMARK(prefix + "SeparateToUnifiedIndices, 2 attributes, 1M indices")
+		{
+			std::vector<uint32_t> indices;
+			std::vector<Vector3> positions;
+			std::vector<Vector2> uvs;
+			MeshUtils::SeparateToUnifiedIndices(kNumIndices, data.positions.data(), data.uvs.data(),
+					data.numAttributes, data.positionData.data(),
+					data.numAttributes, data.uvData.data(),
+					indices, positions, uvs);
+			return positions.size();
+		};
+	}
+}
+
+TEST_CASE("BenchmarkOptimizeVertexCache")
+{
+	// 1M triangles of a grid in random order:
+	const uint32_t size = 724;
+	const Geometry grid = GenerateGrid(size);
+	std::vector<std::array<uint32_t, 3>> triangles(grid.indices.size() / 3);
+	std::memcpy(triangles.data(), grid.indices.data(), grid.indices.size() * sizeof(uint32_t));
+	std::shuffle(triangles.begin(), triangles.end(), std::mt19937(42));
+	const uint32_t* indices = triangles.front().data();
+	const size_t numIndices = triangles.size() * 3;
+	const size_t numVertices = (size + 1) * (size + 1);
+
+	std::vector<uint32_t> optimized(numIndices);
+	BENCHMARK("OptimizeVertexCache, 1M triangles")
+	{
+		MeshUtils::OptimizeVertexCache(indices, numIndices, numVertices, optimized.data());
+		return optimized.back();
+	};
+
+	BENCHMARK("CalculateAcmr, 1M triangles")
+	{
+		return MeshUtils::CalculateAcmr(optimized.data(), numIndices);
+	};
+}
+
+TEST_CASE("BenchmarkSimplify")
+{
+	// UV sphere with 1M triangles:
+	const Geometry sphere = GenerateUvSphere(512, 1024);
+	const std::vector<Vector3>& positions = sphere.positions;
+	const std::vector<uint32_t>& indices = sphere.indices;
+
+	BENCHMARK_ADVANCED("Simplify, 1M to 100k triangles")(Catch::Benchmark::Chronometer meter)
+	{
+		meter.measure([&]
+		{
+			return MeshUtils::Simplify(indices.data(), indices.size(), positions.data(), positions.size(), 100000, 1.0f).size();
+		});
+	};
+}
+
+TEST_CASE("BenchmarkEncodeIndices")
+{
+	const ObjFile32 obj(GenerateSphereObj(512, 1024), 1.0f, ObjPolygonMode::kTriangulate);
+	MeshSet meshes = ObjFileUtils::ObjToMeshSet(obj);
+	REQUIRE(meshes.size() == 1);
+	Mesh& mesh = meshes.front();
+	MeshUtils::OptimizeVertexCache(mesh);
+	MeshUtils::OptimizeVertexFetch(mesh);
+	const std::vector<uint32_t>& indices = mesh.GetIndices();
+	const size_t rawSize = indices.size() * sizeof(uint32_t);
+
+	const std::vector<uint8_t> encoded = MeshUtils::EncodeIndices(indices.data(), indices.size());
+	std::cout << "EncodeIndices: " << indices.size() / 3 << " triangles, " << (encoded.size() * 8.0 / (indices.size() / 3))
+			<< " bits per triangle, " << (100.0 * encoded.size() / rawSize) << "% of raw size" << std::endl;
+
+	std::vector<uint32_t> decoded;
+	const int kRuns = 10;
+	auto start = std::chrono::steady_clock::now();
+	for(int i = 0; i < kRuns; ++i)
+	{
+		decoded.clear();
+		MeshUtils::DecodeIndices(encoded.data(), encoded.size(), decoded);
+	}
+	std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+	std::cout << "DecodeIndices: " << (double(rawSize) * kRuns / duration.count() / 1e6) << " MB/s of indices" << std::endl;
+
+	BENCHMARK("EncodeIndices, 1M triangles from OBJ")
+	{
+		return MeshUtils::EncodeIndices(indices.data(), indices.size()).size();
+	};
+
+	BENCHMARK("DecodeIndices, 1M triangles from OBJ")
+	{
+		decoded.clear();
+		MeshUtils::DecodeIndices(encoded.data(), encoded.size(), decoded);
+		return decoded.size();
+	};
+}
+
+TEST_CASE("BenchmarkEncodeVertexData")
+{
+	const ObjFile32 obj(GenerateSphereObj(512, 1024), 1.0f, ObjPolygonMode::kTriangulate);
+	MeshSet meshes = ObjFileUtils::ObjToMeshSet(obj);
+	REQUIRE(meshes.size() == 1);
+	Mesh& mesh = meshes.front();
+	MeshUtils::OptimizeVertexCache(mesh);
+	MeshUtils::OptimizeVertexFetch(mesh);
+
+	for(Hash name: {VertexAttributeInfo::kPosition, VertexAttributeInfo::kNormal})
+	{
+		const Mesh::Attribute& attribute = mesh.GetAttribute(name);
+		const std::vector<uint8_t> encoded = MeshUtils::EncodeVertexData(attribute);
+		std::cout << "EncodeVertexData: " << (100.0 * encoded.size() / attribute.GetRawSize()) << "% of raw size" << std::endl;
+
+		std::vector<uint8_t> decoded;
+		const int kRuns = 10;
+		auto start = std::chrono::steady_clock::now();
+		for(int i = 0; i < kRuns; ++i)
+			MeshUtils::DecodeVertexData(encoded.data(), encoded.size(), decoded);
+		std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+		std::cout << "DecodeVertexData: " << (double(attribute.GetRawSize()) * kRuns / duration.count() / 1e6) << " MB/s" << std::endl;
+	}
+}
+
+TEST_CASE("BenchmarkInterleave")
+{
+	const ObjFile32 obj(GenerateSphereObj(512, 1024), 1.0f, ObjPolygonMode::kTriangulate);
+	MeshSet meshes = ObjFileUtils::ObjToMeshSet(obj);
+	REQUIRE(meshes.size() == 1);
+	const Mesh& mesh = meshes.front();
+
+	BENCHMARK("Interleave mesh from OBJ")
+	{
+		return MeshUtils::Interleave(mesh).data.size();
+	};
+}
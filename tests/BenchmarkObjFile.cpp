@@ -0,0 +1,257 @@
+/*	BenchmarkObjFile.cpp
+
+MIT License
+
+Copyright (c) 2026 Fabian Herb
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <catch2/catch_test_macros.hpp>
+#include <molecular/util/ObjFile.h>
+#include <molecular/util/ObjTokenizer.h>
+#include <molecular/util/MemoryStreamStorage.h>
+#include <molecular/util/StringUtils.h>
+
+#include <chrono>
+#include <iostream>
+#include <sstream>
+
+using namespace molecular::util;
+
+namespace
+{
+
+/// Grid of quads with positions, texture coordinates and normals
+std::string GenerateObj(int size)
+{
+	std::ostringstream out;
+	for(int y = 0; y <= size; ++y)
+	{
+		for(int x = 0; x <= size; ++x)
+		{
+			out << "v " << x * 0.013f << ' ' << y * 0.017f << " 0.5\n";
+			out << "vt " << float(x) / size << ' ' << float(y) / size << '\n';
+		}
+	}
+	out << "vn 0 0 1\n";
+	out << "g grid\n";
+	for(int y = 0; y < size; ++y)
+	{
+		for(int x = 0; x < size; ++x)
+		{
+			int i = y * (size + 1) + x + 1;
+			int j = i + size + 1;
+			out << "f " << i << '/' << i << "/1 " << i + 1 << '/' << i + 1 << "/1 "
+				<< j + 1 << '/' << j + 1 << "/1 " << j << '/' << j << "/1\n";
+		}
+	}
+	return out.str();
+}
+
+/// Vertex lines only, with full float precision
+std::string GenerateVertices(int count)
+{
+	std::ostringstream out;
+	out.precision(9);
+	for(int i = 0; i < count; ++i)
+		out << "v " << i * 0.0123457f << ' ' << -i * 1.7320508f << ' ' << 1.0f / (i + 1) << '\n';
+	return out.str();
+}
+
+/// Print throughput of a parse function in MB/s
+template<class TFunction>
+void PrintThroughput(const char* name, size_t bytes, TFunction function)
+{
+	const int kRuns = 10;
+	auto start = std::chrono::steady_clock::now();
+	for(int i = 0; i < kRuns; ++i)
+		function();
+	std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+	std::cout << name << ": " << (double(bytes) * kRuns / duration.count() / 1e6) << " MB/s" << std::endl;
+}
+
+std::vector<std::string> Lines(const std::string& text)
+{
+	return StringUtils::Explode(text, '\n');
+}
+
+/// Face line parsing the way ObjFile did before ObjTokenizer
+int ScanFFace(const char* line, int v[4], int t[4], int n[4])
+{
+	int result = StringUtils::ScanF(line, "f %d/%d %d/%d %d/%d %d/%d", &v[0], &t[0], &v[1], &t[1], &v[2], &t[2], &v[3], &t[3]);
+	if(result == 6 || result == 8)
+		return result / 2;
+	result = StringUtils::ScanF(line, "f %d/%d/%d %d/%d/%d %d/%d/%d %d/%d/%d", &v[0], &t[0], &n[0], &v[1], &t[1], &n[1], &v[2], &t[2], &n[2], &v[3], &t[3], &n[3]);
+	if(result == 9 || result == 12)
+		return result / 3;
+	result = StringUtils::ScanF(line, "f %d//%d %d//%d %d//%d %d//%d", &v[0], &n[0], &v[1], &n[1], &v[2], &n[2], &v[3], &n[3]);
+	if(result == 6 || result == 8)
+		return result / 2;
+	return StringUtils::ScanF(line, "f %d %d %d %d", &v[0], &v[1], &v[2], &v[3]);
+}
+
+/// Actor that only counts tokens
+struct CountingActor
+{
+	void Vertex(const Vector3&) {count++;}
+	void TexCoord(const Vector2&) {count++;}
+	void Normal(const Vector3&) {count++;}
+	void Face(const ObjTokenizer::FaceVertex[], size_t n, ObjTokenizer::FaceFormat) {count += n;}
+	void Group(std::string_view) {}
+	void Object(std::string_view) {}
+	void UseMaterial(std::string_view) {}
+	void MaterialLibrary(std::string_view) {}
+
+	size_t count = 0;
+};
+
+}
+
+TEST_CASE("BenchmarkObjTokenizer")
+{
+	const std::string text = GenerateObj(300);
+	const std::vector<std::string> lines = Lines(text);
+
+	BENCHMARK("ScanF")
+	{
+		size_t count = 0;
+		for(auto& line: lines)
+		{
+			const char* l = line.c_str();
+			if(l[0] == 'v' && l[1] == ' ')
+			{
+				float x, y, z;
+				count += StringUtils::ScanF(l, "v %f %f %f", &x, &y, &z);
+			}
+			else if(l[0] == 'v' && l[1] == 't')
+			{
+				float u, v;
+				count += StringUtils::ScanF(l, "vt %f %f", &u, &v);
+			}
+			else if(l[0] == 'f')
+			{
+				int v[4], t[4], n[4];
+				count += ScanFFace(l, v, t, n);
+			}
+		}
+		return count;
+	};
+
+	BENCHMARK("ObjTokenizer")
+	{
+		ObjTokenizer tokenizer;
+		CountingActor actor;
+		for(auto& line: lines)
+			tokenizer.ParseLine(line, actor);
+		return actor.count;
+	};
+}
+
+TEST_CASE("BenchmarkFloatParsing")
+{
+	const std::string text = GenerateVertices(200000);
+	const std::vector<std::string> lines = Lines(text);
+
+	auto scanF = [&]()
+	{
+		float sum = 0;
+		for(auto& line: lines)
+		{
+			float x = 0, y = 0, z = 0;
+			StringUtils::ScanF(line.c_str(), "v %f %f %f", &x, &y, &z);
+			sum += x + y + z;
+		}
+		return sum;
+	};
+
+	auto parseNumber = [&]()
+	{
+		float sum = 0;
+		for(auto& line: lines)
+		{
+			const char* it = line.data() + 1;
+			const char* end = line.data() + line.size();
+			for(int i = 0; i < 3; ++i)
+			{
+				float value = 0;
+				StringUtils::ParseNumber(++it, end, value);
+				sum += value;
+			}
+		}
+		return sum;
+	};
+
+	PrintThroughput("ScanF", text.size(), scanF);
+	PrintThroughput("StringUtils::ParseNumber", text.size(), parseNumber);
+	PrintThroughput("ObjFile", text.size(), [&](){return ObjFile(text).GetVertices().size();});
+
+	BENCHMARK("ScanF") {return scanF();};
+	BENCHMARK("StringUtils::ParseNumber") {return parseNumber();};
+}
+
+TEST_CASE("BenchmarkObjFile")
+{
+	const std::string text = GenerateObj(300);
+
+	BENCHMARK("ObjFile")
+	{
+		MemoryReadStorage storage(text.data(), text.size());
+		TextReadStream<MemoryReadStorage> stream(storage);
+		ObjFile obj(stream);
+		return obj.GetQuads().size();
+	};
+
+	BENCHMARK("ObjFile from memory")
+	{
+		ObjFile obj(text);
+		return obj.GetQuads().size();
+	};
+
+	TaskDispatcher dispatcher;
+	BENCHMARK("ObjFile parallel")
+	{
+		ObjFile obj(text, dispatcher);
+		return obj.GetQuads().size();
+	};
+}
+
+TEST_CASE("BenchmarkObjFileCalculateNormals")
+{
+	const ObjFile32 obj(GenerateObj(1000));
+	TaskDispatcher dispatcher;
+
+	BENCHMARK_ADVANCED("CalculateNormals")(Catch::Benchmark::Chronometer meter)
+	{
+		ObjFile32 copy = obj;
+		meter.measure([&]{copy.CalculateNormals(); return copy.GetNormals().size();});
+	};
+
+	BENCHMARK_ADVANCED("CalculateNormals parallel")(Catch::Benchmark::Chronometer meter)
+	{
+		ObjFile32 copy = obj;
+		meter.measure([&]{copy.CalculateNormals(dispatcher); return copy.GetNormals().size();});
+	};
+
+	BENCHMARK_ADVANCED("CalculateNormals parallel, angle weighted")(Catch::Benchmark::Chronometer meter)
+	{
+		ObjFile32 copy = obj;
+		meter.measure([&]{copy.CalculateNormals(dispatcher, ObjNormalWeighting::kAngle); return copy.GetNormals().size();});
+	};
+}
@@ -0,0 +1,97 @@
+/*	MeshGenerators.h
+
+MIT License
+
+Copyright (c) 2026 Fabian Herb
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef MOLECULAR_TESTS_MESHGENERATORS_H
+#define MOLECULAR_TESTS_MESHGENERATORS_H
+
+#include <molecular/util/Mesh.h>
+#include <molecular/util/Vector3.h>
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+/// Positions and triangle indices of a generated mesh
+struct Geometry
+{
+	/// Create mesh with positions and indices
+	molecular::util::Mesh ToMesh() const
+	{
+		using namespace molecular::util;
+		Mesh mesh(positions.size());
+		mesh.SetAttributeData(VertexAttributeInfo::kPosition, positions.data(), positions.size());
+		mesh.GetIndices() = indices;
+		return mesh;
+	}
+
+	std::vector<molecular::util::Vector3> positions;
+	std::vector<uint32_t> indices;
+};
+
+/// Grid of size by size unit quads in the XY plane, facing +Z
+inline Geometry GenerateGrid(uint32_t size)
+{
+	Geometry grid;
+	for(uint32_t y = 0; y <= size; ++y)
+		for(uint32_t x = 0; x <= size; ++x)
+			grid.positions.push_back(molecular::util::Vector3(x, y, 0));
+	for(uint32_t y = 0; y < size; ++y)
+	{
+		for(uint32_t x = 0; x < size; ++x)
+		{
+			const uint32_t v = y * (size + 1) + x;
+			grid.indices.insert(grid.indices.end(), {v, v + 1, v + size + 2, v, v + size + 2, v + size + 1});
+		}
+	}
+	return grid;
+}
+
+/// UV sphere with radius 1
+/** The first and last vertex of each ring share their position like at a
+	texture seam, and each pole consists of one vertex per segment. */
+inline Geometry GenerateUvSphere(uint32_t rings, uint32_t segments)
+{
+	Geometry sphere;
+	for(uint32_t ring = 0; ring <= rings; ++ring)
+	{
+		const float theta = 3.14159265f * ring / rings;
+		for(uint32_t segment = 0; segment <= segments; ++segment)
+		{
+			const float phi = 2 * 3.14159265f * (segment % segments) / segments;
+			sphere.positions.push_back(molecular::util::Vector3(std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), std::cos(theta)));
+		}
+	}
+	for(uint32_t ring = 0; ring < rings; ++ring)
+	{
+		for(uint32_t segment = 0; segment < segments; ++segment)
+		{
+			const uint32_t v = ring * (segments + 1) + segment;
+			sphere.indices.insert(sphere.indices.end(), {v, v + segments + 1, v + 1, v + 1, v + segments + 1, v + segments + 2});
+		}
+	}
+	return sphere;
+}
+
+#endif // MOLECULAR_TESTS_MESHGENERATORS_H
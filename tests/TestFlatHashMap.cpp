@@ -0,0 +1,82 @@
+/*	TestFlatHashMap.cpp
+
+MIT License
+
+Copyright (c) 2026 Fabian Herb
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <catch2/catch_test_macros.hpp>
+#include <molecular/util/FlatHashMap.h>
+
+#include <unordered_map>
+
+using namespace molecular::util;
+
+TEST_CASE("TestFlatHashMap")
+{
+	FlatHashMap<uint64_t, uint32_t> map;
+	CHECK(map.IsEmpty());
+	CHECK(map.Find(42) == nullptr);
+
+	auto result = map.Insert(42, 1);
+	CHECK(result.second);
+	CHECK(*result.first == 1);
+	result = map.Insert(42, 2);
+	CHECK_FALSE(result.second);
+	CHECK(*result.first == 1);
+	CHECK(map.GetSize() == 1);
+
+	// Grows beyond the initial capacity and keeps its contents:
+	std::unordered_map<uint64_t, uint32_t> reference;
+	for(uint64_t i = 0; i < 10000; ++i)
+	{
+		const uint64_t key = (i * 7919) << 21; // Low bits all zero
+		map.Insert(key, uint32_t(i));
+		reference.emplace(key, uint32_t(i));
+	}
+	CHECK(map.GetSize() == reference.size() + 1);
+	CHECK(map.GetCapacity() >= map.GetSize() * 4 / 3);
+	for(auto& entry: reference)
+	{
+		const uint32_t* value = map.Find(entry.first);
+		REQUIRE(value);
+		CHECK(*value == entry.second);
+	}
+
+	const size_t capacity = map.GetCapacity();
+	map.Clear();
+	CHECK(map.IsEmpty());
+	CHECK(map.GetCapacity() == capacity);
+	CHECK(map.Find(42) == nullptr);
+	CHECK(map.Insert(42, 3).second);
+	CHECK(*map.Find(42) == 3);
+}
+
+TEST_CASE("TestFlatHashMapReserve")
+{
+	FlatHashMap<uint32_t, int> map(1000);
+	const size_t capacity = map.GetCapacity();
+	CHECK(capacity >= 1000 * 4 / 3);
+	for(uint32_t i = 0; i < 1000; ++i)
+		map.Insert(i, -int(i));
+	CHECK(map.GetCapacity() == capacity);
+	CHECK(*map.Find(999) == -999);
+}
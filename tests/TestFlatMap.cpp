@@ -0,0 +1,117 @@
+/*	TestFlatMap.cpp
+
+MIT License
+
+Copyright (c) 2026 Fabian Herb
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <catch2/catch_test_macros.hpp>
+#include <molecular/util/FlatMap.h>
+#include <molecular/util/Mesh.h>
+
+#include <map>
+#include <memory>
+#include <random>
+#include <type_traits>
+
+using namespace molecular::util;
+
+TEST_CASE("TestFlatMap")
+{
+	FlatMap<uint32_t, std::unique_ptr<int>> map;
+	CHECK(map.empty());
+	CHECK(map.find(42) == map.end());
+	CHECK(map.count(42) == 0);
+	CHECK_THROWS_AS(map.at(42), std::out_of_range);
+
+	auto result = map.emplace(42, std::make_unique<int>(1));
+	CHECK(result.second);
+	CHECK(*result.first->second == 1);
+	result = map.emplace(42, std::make_unique<int>(2));
+	CHECK_FALSE(result.second);
+	CHECK(*map.at(42) == 1);
+	CHECK(map.size() == 1);
+
+	map[7] = std::make_unique<int>(3);
+	CHECK(*map.at(7) == 3);
+	CHECK(map.erase(7) == 1);
+	CHECK(map.erase(7) == 0);
+	CHECK(map.count(7) == 0);
+
+	// Keys cannot be changed through iterators, which would break the order:
+	static_assert(std::is_const<std::remove_reference_t<decltype(map.begin()->first)>>::value, "Keys must be const");
+	static_assert(std::is_const<std::remove_reference_t<decltype((*map.begin()).first)>>::value, "Keys must be const");
+	map.emplace(3, std::make_unique<int>(4));
+	map.emplace(50, std::make_unique<int>(5));
+	auto next = map.erase(map.find(42));
+	REQUIRE(next != map.end());
+	CHECK(next->first == 50);
+	CHECK(*map.at(3) == 4);
+
+	// Same contents and order as std::map:
+	std::mt19937 random(42);
+	FlatMap<uint32_t, uint32_t> flat;
+	std::map<uint32_t, uint32_t> reference;
+	for(uint32_t i = 0; i < 1000; ++i)
+	{
+		const uint32_t key = random() % 500;
+		CHECK(flat.emplace(key, i).second == reference.emplace(key, i).second);
+		if(i % 3 == 0)
+			CHECK(flat.erase(i % 500) == reference.erase(i % 500));
+	}
+	REQUIRE(flat.size() == reference.size());
+	auto it = reference.begin();
+	for(auto& entry: flat)
+	{
+		CHECK(entry.first == it->first);
+		CHECK(entry.second == it->second);
+		++it;
+	}
+}
+
+TEST_CASE("TestMeshAttributeOrder")
+{
+	// Iteration order does not depend on insertion order:
+	const float data[] = {1, 2, 3};
+	Mesh a(1), b(1);
+	a.SetAttributeData(VertexAttributeInfo::kPosition, VertexAttributeInfo::kFloat, 3, data, sizeof(data));
+	a.SetAttributeData(VertexAttributeInfo::kNormal, VertexAttributeInfo::kFloat, 3, data, sizeof(data));
+	a.SetAttributeData(VertexAttributeInfo::kTextureCoords, VertexAttributeInfo::kFloat, 2, data, 8);
+	b.SetAttributeData(VertexAttributeInfo::kTextureCoords, VertexAttributeInfo::kFloat, 2, data, 8);
+	b.SetAttributeData(VertexAttributeInfo::kNormal, VertexAttributeInfo::kFloat, 3, data, sizeof(data));
+	b.SetAttributeData(VertexAttributeInfo::kPosition, VertexAttributeInfo::kFloat, 3, data, sizeof(data));
+
+	auto itB = b.GetAttributes().begin();
+	Hash previous = 0;
+	for(auto& attribute: a.GetAttributes())
+	{
+		CHECK(attribute.first == itB->first);
+		CHECK(attribute.first > previous);
+		previous = attribute.first;
+		++itB;
+	}
+
+	// Attribute data stays valid when other attributes are added:
+	const float* position = static_cast<const float*>(a.GetAttribute(VertexAttributeInfo::kPosition).GetRawData());
+	CHECK(position[2] == 3);
+	a.SetAttributeData(VertexAttributeInfo::kSkinWeights, VertexAttributeInfo::kFloat, 3, data, sizeof(data));
+	CHECK(static_cast<const float*>(a.GetAttribute(VertexAttributeInfo::kPosition).GetRawData())[2] == 3);
+}
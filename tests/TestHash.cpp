@@ -58,3 +58,11 @@ TEST_CASE("TestMurmurHash")
 	CHECK("vertexSkinWeightsAttr"_H == 0xfc228c1f);
 	CHECK("vertexSkinJointsAttr"_H == 0xe2cf8e75);
 }
+
+TEST_CASE("TestMurmurHashData")
+{
+	const char text[] = "vertexSkinWeightsAttr with a somewhat longer tail\xe4\xf6";
+	for(size_t length = 0; length < sizeof(text); ++length)
+		CHECK(Murmur::HashData(text, length) == Murmur::Hash(text, length));
+	CHECK(Murmur::HashData("laber", 5, 7) == Murmur::Hash("laber", 5, 7));
+}
@@ -0,0 +1,919 @@
+/*	TestMeshUtils.cpp
+
+MIT License
+
+Copyright (c) 2026 Fabian Herb
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <catch2/catch_test_macros.hpp>
+#include <molecular/util/MeshUtils.h>
+#include "MeshGenerators.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <random>
+
+using namespace molecular::util;
+
+namespace
+{
+
+/// Rotate each triangle so that its smallest index comes first
+std::vector<uint32_t> CanonicalTriangles(std::vector<uint32_t> indices)
+{
+	for(size_t i = 0; i < indices.size(); i += 3)
+	{
+		while(indices[i] > indices[i + 1] || indices[i] > indices[i + 2])
+			std::rotate(indices.begin() + i, indices.begin() + i + 1, indices.begin() + i + 3);
+	}
+	return indices;
+}
+
+}
+
+TEST_CASE("TestSeparateToUnifiedIndices")
+{
+	// Two triangles sharing an edge, with a texture seam along it:
+	const uint32_t positionIndices[] = {0, 1, 2, 2, 1, 3};
+	const uint32_t normalIndices[] = {0, 0, 0, 0, 0, 0};
+	const uint32_t uvIndices[] = {0, 1, 2, 3, 1, 4};
+	const Vector3 positions[] = {{0, 0, 0}, {1, 0, 0}, {0, 1, 0}, {1, 1, 0}};
+	const Vector3 normals[] = {{0, 0, 1}};
+	const Vector2 uvs[] = {{0, 0}, {1, 0}, {0, 1}, {0.5f, 1}, {1, 1}};
+
+	std::vector<uint32_t> outIndices;
+	std::vector<Vector3> outPositions, outNormals;
+	std::vector<Vector2> outUvs;
+	MeshUtils::SeparateToUnifiedIndices(6, positionIndices, normalIndices, uvIndices,
+			4, positions, 1, normals, 5, uvs,
+			outIndices, outPositions, outNormals, outUvs);
+
+	CHECK(outIndices == std::vector<uint32_t>{0, 1, 2, 3, 1, 4});
+	REQUIRE(outPositions.size() == 5);
+	CHECK(outPositions[3] == positions[2]);
+	CHECK(outPositions[4] == positions[3]);
+	CHECK(outNormals.size() == 5);
+	CHECK(outUvs[3] == uvs[3]);
+
+	// Reusing scratch memory gives the same result:
+	MeshUtils::UnifiedIndicesScratch scratch;
+	for(int i = 0; i < 2; ++i)
+	{
+		std::vector<uint32_t> indices;
+		std::vector<Vector3> p;
+		std::vector<Vector2> t;
+		MeshUtils::SeparateToUnifiedIndices(6, positionIndices, uvIndices, 4, positions, 5, uvs, indices, p, t, scratch);
+		CHECK(indices == outIndices);
+		CHECK(p == outPositions);
+	}
+
+	// Appending in many calls does not reallocate every time:
+	std::vector<uint32_t> appendedIndices;
+	std::vector<Vector3> appendedPositions;
+	std::vector<Vector2> appendedUvs;
+	size_t reallocations = 0;
+	for(int i = 0; i < 1000; ++i)
+	{
+		const uint32_t* before = appendedIndices.data();
+		MeshUtils::SeparateToUnifiedIndices(6, positionIndices, uvIndices, 4, positions, 5, uvs,
+				appendedIndices, appendedPositions, appendedUvs, scratch);
+		if(appendedIndices.data() != before)
+			reallocations++;
+	}
+	CHECK(appendedIndices.size() == 6000);
+	CHECK(reallocations < 20);
+}
+
+TEST_CASE("TestSeparateToUnifiedIndicesWide")
+{
+	// The first two vertices would collide if indices were packed into 21 bits each:
+	const uint32_t k21 = 1 << 21;
+	const uint32_t indices0[] = {k21, 0, k21 - 1, k21, 0};
+	const uint32_t indices1[] = {0, 1, 0, 0, 1};
+	const uint32_t indices2[] = {0, 0, 0, 1, 0};
+	std::vector<uint32_t> attributes(k21 + 1);
+	for(uint32_t i = 0; i < attributes.size(); ++i)
+		attributes[i] = i;
+
+	std::vector<uint32_t> outIndices, out0, out1, out2;
+	MeshUtils::SeparateToUnifiedIndices(5, indices0, indices1, indices2,
+			attributes.size(), attributes.data(),
+			attributes.size(), attributes.data(),
+			attributes.size(), attributes.data(),
+			outIndices, out0, out1, out2);
+	CHECK(outIndices == std::vector<uint32_t>{0, 1, 2, 3, 1});
+	CHECK(out0 == std::vector<uint32_t>{k21, 0, k21 - 1, k21});
+	CHECK(out1 == std::vector<uint32_t>{0, 1, 0, 0});
+	CHECK(out2 == std::vector<uint32_t>{0, 0, 0, 1});
+}
+
+TEST_CASE("TestSeparateToUnifiedIndicesSorted")
+{
+	// Random indices spanning several sort blocks, compared with the hash based variant:
+	std::mt19937 random(42);
+	const size_t numIndices = 200000;
+	const uint32_t numAttributes = 300;
+	std::vector<uint32_t> indices0(numIndices), indices1(numIndices), indices2(numIndices);
+	for(size_t i = 0; i < numIndices; ++i)
+	{
+		indices0[i] = random() % numAttributes;
+		indices1[i] = random() % 4;
+		indices2[i] = random() % numAttributes;
+	}
+	std::vector<uint32_t> attributes(numAttributes);
+	for(uint32_t i = 0; i < numAttributes; ++i)
+		attributes[i] = i * 7;
+
+	StdTaskQueue queue;
+	std::vector<uint32_t> expectedIndices, expected0, expected1, expected2;
+	std::vector<uint32_t> outIndices, out0, out1, out2;
+	SECTION("Three attributes")
+	{
+		expectedIndices = outIndices = {5, 6};
+		MeshUtils::SeparateToUnifiedIndices(numIndices, indices0.data(), indices1.data(), indices2.data(),
+				numAttributes, attributes.data(), 4, attributes.data(), numAttributes, attributes.data(),
+				expectedIndices, expected0, expected1, expected2);
+		MeshUtils::SeparateToUnifiedIndices(queue, numIndices, indices0.data(), indices1.data(), indices2.data(),
+				numAttributes, attributes.data(), 4, attributes.data(), numAttributes, attributes.data(),
+				outIndices, out0, out1, out2);
+		CHECK(out2 == expected2);
+	}
+	SECTION("Two attributes")
+	{
+		MeshUtils::SeparateToUnifiedIndices(numIndices, indices0.data(), indices2.data(),
+				numAttributes, attributes.data(), numAttributes, attributes.data(),
+				expectedIndices, expected0, expected1);
+		MeshUtils::SeparateToUnifiedIndices(queue, numIndices, indices0.data(), indices2.data(),
+				numAttributes, attributes.data(), numAttributes, attributes.data(),
+				outIndices, out0, out1);
+	}
+	CHECK(outIndices == expectedIndices);
+	CHECK(out0 == expected0);
+	CHECK(out1 == expected1);
+}
+
+TEST_CASE("TestUnifyIndicesBySorting")
+{
+	// Combined key exceeds 64 bits, so unification happens in two stages:
+	const uint32_t big = 1u << 31;
+	const uint32_t indices0[] = {big, 0, big, big, 0, 1};
+	const uint32_t indices1[] = {0, big, 0, 0, big, 1};
+	const uint32_t indices2[] = {big, 1, big, 0, 1, 1};
+	const uint32_t* const indices[] = {indices0, indices1, indices2};
+	const size_t numAttributes[] = {size_t(big) + 1, size_t(big) + 1, size_t(big) + 1};
+
+	StdTaskQueue queue;
+	std::vector<uint32_t> outIndices, firstOccurrences;
+	MeshUtils::UnifyIndicesBySorting(queue, 6, 3, indices, numAttributes, 10, outIndices, firstOccurrences);
+	CHECK(outIndices == std::vector<uint32_t>{10, 11, 10, 12, 11, 13});
+	CHECK(firstOccurrences == std::vector<uint32_t>{0, 1, 3, 5});
+}
+
+TEST_CASE("TestUnifyIndicesBySortingLongRun")
+{
+	// A single run of equal keys spanning several sort blocks:
+	const size_t numIndices = 200000;
+	const std::vector<uint32_t> indices0(numIndices, 3), indices1(numIndices, 5), indices2(numIndices, 7);
+	const uint32_t* const indices[] = {indices0.data(), indices1.data(), indices2.data()};
+	const size_t numAttributes[] = {4, 6, 8};
+
+	StdTaskQueue queue;
+	std::vector<uint32_t> outIndices, firstOccurrences;
+	MeshUtils::UnifyIndicesBySorting(queue, numIndices, 3, indices, numAttributes, 10, outIndices, firstOccurrences);
+	CHECK(outIndices == std::vector<uint32_t>(numIndices, 10));
+	CHECK(firstOccurrences == std::vector<uint32_t>{0});
+}
+
+TEST_CASE("TestOptimizeVertexCache")
+{
+	// Grid with randomly ordered triangles:
+	const uint32_t size = 64;
+	const std::vector<uint32_t> triangles = GenerateGrid(size).indices;
+	std::vector<std::array<uint32_t, 3>> shuffled(triangles.size() / 3);
+	std::memcpy(shuffled.data(), triangles.data(), triangles.size() * sizeof(uint32_t));
+	std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(42));
+
+	const uint32_t numVertices = (size + 1) * (size + 1);
+	Mesh mesh(numVertices);
+	std::vector<uint32_t>& indices = mesh.GetIndices();
+	indices.resize(triangles.size());
+	std::memcpy(indices.data(), shuffled.data(), indices.size() * sizeof(uint32_t));
+
+	auto statistics = MeshUtils::OptimizeVertexCache(mesh);
+	CHECK(statistics.acmrBefore > 2.0f);
+	CHECK(statistics.acmrAfter < 0.8f);
+	CHECK(statistics.acmrAfter == MeshUtils::CalculateAcmr(indices.data(), indices.size()));
+
+	// Same triangles with the same winding:
+	std::vector<std::array<uint32_t, 3>> optimized(indices.size() / 3);
+	std::memcpy(optimized.data(), indices.data(), indices.size() * sizeof(uint32_t));
+	std::sort(shuffled.begin(), shuffled.end());
+	std::sort(optimized.begin(), optimized.end());
+	CHECK(optimized == shuffled);
+
+	// Every triangle is a miss without reuse:
+	const uint32_t separate[] = {0, 1, 2, 3, 4, 5};
+	CHECK(MeshUtils::CalculateAcmr(separate, 6) == 3.0f);
+
+	Mesh points(1, IndexBufferInfo::Mode::kPoints);
+	CHECK_THROWS_AS(MeshUtils::OptimizeVertexCache(points), std::runtime_error);
+}
+
+TEST_CASE("TestOptimizeVertexFetch")
+{
+	// Vertex 1 is unused:
+	const Vector3 positions[] = {{0, 0, 0}, {1, 0, 0}, {2, 0, 0}, {3, 0, 0}, {4, 0, 0}};
+	const uint16_t halfs[] = {0, 1, 2, 10, 11, 12, 20, 21, 22, 30, 31, 32, 40, 41, 42};
+	Mesh mesh(5);
+	mesh.SetAttributeData(VertexAttributeInfo::kPosition, positions, 5);
+	mesh.SetAttributeData(VertexAttributeInfo::kNormal, VertexAttributeInfo::kHalf, 3, halfs, sizeof(halfs));
+	mesh.GetIndices() = {4, 2, 0, 3, 2, 4};
+
+	MeshUtils::OptimizeVertexFetch(mesh);
+	CHECK(mesh.GetIndices() == std::vector<uint32_t>{0, 1, 2, 3, 1, 0});
+	const Vector3* outPositions = mesh.GetAttribute(VertexAttributeInfo::kPosition).GetData<Vector3>();
+	CHECK(outPositions[0] == positions[4]);
+	CHECK(outPositions[1] == positions[2]);
+	CHECK(outPositions[2] == positions[0]);
+	CHECK(outPositions[3] == positions[3]);
+	CHECK(outPositions[4] == positions[1]);
+	const auto& normals = mesh.GetAttribute(VertexAttributeInfo::kNormal);
+	CHECK(normals.GetType() == VertexAttributeInfo::kHalf);
+	const uint16_t* outHalfs = static_cast<const uint16_t*>(normals.GetRawData());
+	CHECK(std::vector<uint16_t>(outHalfs, outHalfs + 15) == std::vector<uint16_t>{40, 41, 42, 20, 21, 22, 0, 1, 2, 30, 31, 32, 10, 11, 12});
+
+	// Invalid input leaves the mesh untouched:
+	CHECK_THROWS_AS(MeshUtils::RemapVertices(mesh, {0, 1, 2, 3, 5}), std::runtime_error);
+	CHECK_THROWS_AS(MeshUtils::RemapVertices(mesh, {0, 1, 2, 3, 3}), std::runtime_error);
+	mesh.SetAttributeData(VertexAttributeInfo::kVertexPrt0, VertexAttributeInfo::kFloat, 1, positions, 7 * sizeof(float));
+	CHECK_THROWS_AS(MeshUtils::RemapVertices(mesh, {4, 3, 2, 1, 0}), std::runtime_error);
+	mesh.GetIndices().push_back(5);
+	CHECK_THROWS_AS(MeshUtils::RemapVertices(mesh, {4, 3, 2, 1, 0}), std::runtime_error);
+	CHECK(mesh.GetAttribute(VertexAttributeInfo::kPosition).GetData<Vector3>()[0] == positions[4]);
+	CHECK(mesh.GetIndices() == std::vector<uint32_t>{0, 1, 2, 3, 1, 0, 5});
+}
+
+TEST_CASE("TestOptimizeOverdraw")
+{
+	// UV sphere with randomly ordered triangles:
+	const Geometry sphere = GenerateUvSphere(32, 64);
+	const std::vector<Vector3>& positions = sphere.positions;
+	std::vector<std::array<uint32_t, 3>> triangles(sphere.indices.size() / 3);
+	std::memcpy(triangles.data(), sphere.indices.data(), sphere.indices.size() * sizeof(uint32_t));
+	std::shuffle(triangles.begin(), triangles.end(), std::mt19937(42));
+
+	Mesh mesh(positions.size());
+	mesh.SetAttributeData(VertexAttributeInfo::kPosition, positions.data(), positions.size());
+	std::vector<uint32_t>& indices = mesh.GetIndices();
+	indices.resize(triangles.size() * 3);
+	std::memcpy(indices.data(), triangles.data(), indices.size() * sizeof(uint32_t));
+
+	std::vector<uint32_t> cacheOptimized(indices.size());
+	MeshUtils::OptimizeVertexCache(indices.data(), indices.size(), positions.size(), cacheOptimized.data());
+	const float tipsifyAcmr = MeshUtils::CalculateAcmr(cacheOptimized.data(), cacheOptimized.size());
+
+	std::vector<uint32_t> clustered(indices.size());
+	MeshUtils::OptimizeOverdraw(indices.data(), indices.size(), positions.data(), positions.size(), clustered.data(), 3.0f);
+	const float clusteredAcmr = MeshUtils::CalculateAcmr(clustered.data(), clustered.size());
+
+	auto statistics = MeshUtils::OptimizeOverdraw(mesh);
+	CHECK(statistics.acmrBefore > 2.0f);
+	CHECK(statistics.acmrAfter >= tipsifyAcmr);
+	CHECK(statistics.acmrAfter <= clusteredAcmr);
+	CHECK(clusteredAcmr < 3.0f);
+
+	// Same triangles with the same winding:
+	std::vector<std::array<uint32_t, 3>> optimized(indices.size() / 3);
+	std::memcpy(optimized.data(), indices.data(), indices.size() * sizeof(uint32_t));
+	std::sort(triangles.begin(), triangles.end());
+	std::sort(optimized.begin(), optimized.end());
+	CHECK(optimized == triangles);
+
+	Mesh noPositions(3);
+	CHECK_THROWS_AS(MeshUtils::OptimizeOverdraw(noPositions), std::runtime_error);
+
+	// Quantized positions are rejected instead of being read as floats:
+	MeshUtils::ReducePrecision(mesh, {{VertexAttributeInfo::kPosition, MeshUtils::Quantization::kBoxUNorm16}});
+	CHECK_THROWS_AS(MeshUtils::OptimizeOverdraw(mesh), std::runtime_error);
+	CHECK_THROWS_AS(MeshUtils::BuildMeshlets(mesh), std::runtime_error);
+	CHECK_THROWS_AS(MeshUtils::Simplify(mesh, 10, 1.0f), std::runtime_error);
+	CHECK_THROWS_AS(MeshUtils::SimplifyLodChain(mesh, 2), std::runtime_error);
+	Mesh tooFewPositions(3);
+	const Vector3 onePosition(0, 0, 0);
+	tooFewPositions.SetAttributeData(VertexAttributeInfo::kPosition, VertexAttributeInfo::kFloat, 3, &onePosition, sizeof(onePosition));
+	tooFewPositions.GetIndices() = {0, 1, 2};
+	CHECK_THROWS_AS(MeshUtils::OptimizeOverdraw(tooFewPositions), std::runtime_error);
+}
+
+TEST_CASE("TestOptimizeOverdrawOrder")
+{
+	// Flat patches facing away from or towards the center, so every triangle has the sort key of its cluster:
+	struct Patch {Vector3 origin, u, v;};
+	const Patch patches[] = {
+		{Vector3(-1, -1, 3), Vector3(1, 0, 0), Vector3(0, 1, 0)}, // Facing outwards far from the center
+		{Vector3(-1, -1, -1), Vector3(0, 1, 0), Vector3(1, 0, 0)}, // Facing outwards
+		{Vector3(2, -1, -1), Vector3(0, 1, 0), Vector3(0, 0, 1)}, // Facing outwards
+		{Vector3(-2, -1, -1), Vector3(0, 1, 0), Vector3(0, 0, 1)}, // Facing inwards
+	};
+	const uint32_t kSize = 8;
+	const Geometry grid = GenerateGrid(kSize);
+	std::vector<Vector3> positions;
+	std::vector<std::array<uint32_t, 3>> triangles;
+	for(auto& patch: patches)
+	{
+		const uint32_t base = uint32_t(positions.size());
+		for(auto& p: grid.positions)
+			positions.push_back(patch.origin + patch.u * (2.0f * p[0] / kSize) + patch.v * (2.0f * p[1] / kSize));
+		for(size_t i = 0; i < grid.indices.size(); i += 3)
+			triangles.push_back({base + grid.indices[i], base + grid.indices[i + 1], base + grid.indices[i + 2]});
+	}
+	std::shuffle(triangles.begin(), triangles.end(), std::mt19937(42));
+
+	Mesh mesh(positions.size());
+	mesh.SetAttributeData(VertexAttributeInfo::kPosition, positions.data(), positions.size());
+	std::vector<uint32_t>& indices = mesh.GetIndices();
+	indices.resize(triangles.size() * 3);
+	std::memcpy(indices.data(), triangles.data(), indices.size() * sizeof(uint32_t));
+	MeshUtils::OptimizeOverdraw(mesh);
+
+	// Same area weighted mesh centroid as OptimizeOverdraw(), all triangles have the same area:
+	Vector3 meshCentroid(0, 0, 0);
+	for(size_t i = 0; i < indices.size(); ++i)
+		meshCentroid += positions[indices[i]];
+	meshCentroid /= float(indices.size());
+
+	std::vector<float> keys;
+	for(size_t i = 0; i < indices.size(); i += 3)
+	{
+		const Vector3& p0 = positions[indices[i]];
+		const Vector3& p1 = positions[indices[i + 1]];
+		const Vector3& p2 = positions[indices[i + 2]];
+		const Vector3 normal = (p1 - p0).CrossProduct(p2 - p0).Normalized();
+		keys.push_back(((p0 + p1 + p2) / 3.0f - meshCentroid).DotProduct(normal));
+	}
+	for(size_t i = 1; i < keys.size(); ++i)
+		REQUIRE(keys[i] <= keys[i - 1] + 1e-4f);
+	CHECK(keys.front() > keys.back() + 1.0f);
+}
+
+TEST_CASE("TestBuildMeshlets")
+{
+	// Flat grid in the XY plane facing +Z:
+	const uint32_t size = 32;
+	const Geometry grid = GenerateGrid(size);
+	const std::vector<Vector3>& positions = grid.positions;
+	Mesh mesh = grid.ToMesh();
+	std::vector<uint32_t>& indices = mesh.GetIndices();
+	MeshUtils::OptimizeVertexCache(mesh);
+
+	MeshUtils::MeshletSet set = MeshUtils::BuildMeshlets(mesh);
+	REQUIRE(!set.meshlets.empty());
+	std::vector<uint32_t> reconstructed;
+	for(const MeshUtils::Meshlet& meshlet: set.meshlets)
+	{
+		CHECK(meshlet.vertexCount <= 64);
+		CHECK(meshlet.triangleCount <= 124);
+		for(uint32_t i = 0; i < meshlet.triangleCount * 3; ++i)
+		{
+			const uint8_t local = set.triangles[meshlet.triangleOffset + i];
+			REQUIRE(local < meshlet.vertexCount);
+			reconstructed.push_back(set.vertices[meshlet.vertexOffset + local]);
+		}
+		for(uint32_t i = 0; i < meshlet.vertexCount; ++i)
+		{
+			const Vector3& p = positions[set.vertices[meshlet.vertexOffset + i]];
+			CHECK(meshlet.boundingBox.Contains(p));
+			CHECK((p - meshlet.sphereCenter).Length() <= meshlet.sphereRadius * 1.0001f);
+		}
+		CHECK(meshlet.coneAxis == Vector3(0, 0, 1));
+		CHECK(meshlet.coneCutoff == 0.0f);
+		CHECK(meshlet.IsBackfacing(meshlet.sphereCenter - Vector3(0, 0, 100)));
+		CHECK(!meshlet.IsBackfacing(meshlet.sphereCenter + Vector3(0, 0, 100)));
+	}
+	CHECK(reconstructed == indices);
+	CHECK(set.meshlets.size() < 2 * size * size / 80); // Vertex limit is reached at about 90 triangles
+
+	CHECK_THROWS_AS(MeshUtils::BuildMeshlets(mesh, 257), std::range_error);
+}
+
+TEST_CASE("TestSimplify")
+{
+	// UV sphere, with duplicated vertices along the texture seam and at the poles:
+	const uint32_t rings = 32, segments = 64;
+	const Geometry sphere = GenerateUvSphere(rings, segments);
+	const std::vector<Vector3>& positions = sphere.positions;
+	Mesh mesh = sphere.ToMesh();
+	const std::vector<uint32_t>& indices = mesh.GetIndices();
+
+	float error = -1;
+	std::vector<uint32_t> simplified = MeshUtils::Simplify(mesh, 1024, 1.0f, &error);
+	CHECK(simplified.size() / 3 <= 1024);
+	CHECK(simplified.size() / 3 > 512);
+	CHECK(error > 0.0f);
+	CHECK(error < 0.2f);
+
+	// Seam vertices stay in place:
+	std::vector<bool> used(positions.size(), false);
+	for(uint32_t index: simplified)
+		used.at(index) = true;
+	for(uint32_t ring = 1; ring < rings; ++ring)
+	{
+		CHECK(used[ring * (segments + 1)]);
+		CHECK(used[ring * (segments + 1) + segments]);
+	}
+
+	// Curved surface can not be simplified without error:
+	CHECK(MeshUtils::Simplify(mesh, 1024, 0.0f, &error).size() == indices.size());
+	CHECK(error == 0.0f);
+
+	std::vector<std::vector<uint32_t>> lods = MeshUtils::SimplifyLodChain(mesh, 4);
+	REQUIRE(lods.size() == 4);
+	CHECK(lods[0] == indices);
+	for(size_t level = 1; level < lods.size(); ++level)
+		CHECK(lods[level].size() <= lods[level - 1].size() / 2);
+}
+
+TEST_CASE("TestSimplifyPlane")
+{
+	// Interior of a flat grid collapses without error, the open border is kept:
+	const uint32_t size = 16;
+	const Geometry grid = GenerateGrid(size);
+	const std::vector<Vector3>& positions = grid.positions;
+	const std::vector<uint32_t>& indices = grid.indices;
+
+	float error = -1;
+	std::vector<uint32_t> simplified = MeshUtils::Simplify(indices.data(), indices.size(), positions.data(), positions.size(), 0, 0.0f, &error);
+	CHECK(error == 0.0f);
+	CHECK(simplified.size() / 3 <= 4 * size); // About one triangle per border vertex
+	std::vector<bool> used(positions.size(), false);
+	for(uint32_t index: simplified)
+		used[index] = true;
+	for(uint32_t i = 0; i <= size; ++i)
+	{
+		CHECK(used[i]);
+		CHECK(used[size * (size + 1) + i]);
+	}
+
+	// Flat shaded grid only has seam vertices, which are all locked:
+	std::vector<Vector3> flatPositions;
+	std::vector<uint32_t> flatIndices;
+	for(uint32_t index: indices)
+	{
+		flatIndices.push_back(uint32_t(flatPositions.size()));
+		flatPositions.push_back(positions[index]);
+	}
+	simplified = MeshUtils::Simplify(flatIndices.data(), flatIndices.size(), flatPositions.data(), flatPositions.size(), 0, 1.0f, &error);
+	CHECK(simplified == flatIndices);
+	CHECK(error == 0.0f);
+}
+
+TEST_CASE("TestReducePrecision")
+{
+	// Attributes of unexpected types are skipped:
+	const Vector3 normals[] = {{0, 0, 1}, {0, 1, 0}};
+	const IntVector4 joints[] = {{1, 2, 3, 4}, {5, 6, 7, 8}};
+	const float weights[] = {0.5f, 0.25f};
+	Mesh mesh(2);
+	mesh.SetAttributeData(VertexAttributeInfo::kPosition, normals, 2);
+	mesh.SetAttributeData(VertexAttributeInfo::kNormal, normals, 2);
+	mesh.SetAttributeData(VertexAttributeInfo::kSkinJoints, joints, 2);
+	mesh.SetAttributeData(VertexAttributeInfo::kSkinWeights, VertexAttributeInfo::kInt32, 1, weights, sizeof(weights));
+	MeshUtils::ReducePrecision(mesh);
+
+	CHECK(mesh.GetAttribute(VertexAttributeInfo::kPosition).GetType() == VertexAttributeInfo::kFloat);
+	const Mesh::Attribute& outNormals = mesh.GetAttribute(VertexAttributeInfo::kNormal);
+	CHECK(outNormals.GetType() == VertexAttributeInfo::kHalf);
+	CHECK(outNormals.GetRawSize() == 12);
+	const Mesh::Attribute& outJoints = mesh.GetAttribute(VertexAttributeInfo::kSkinJoints);
+	REQUIRE(outJoints.GetType() == VertexAttributeInfo::kInt8);
+	const int8_t* jointData = static_cast<const int8_t*>(outJoints.GetRawData());
+	CHECK(std::vector<int8_t>(jointData, jointData + 8) == std::vector<int8_t>{1, 2, 3, 4, 5, 6, 7, 8});
+	CHECK(mesh.GetAttribute(VertexAttributeInfo::kSkinWeights).GetType() == VertexAttributeInfo::kInt32);
+}
+
+TEST_CASE("TestReducePrecisionQuantization")
+{
+	std::mt19937 random(42);
+	std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+	const size_t count = 1000;
+	std::vector<Vector3> positions(count), normals(count);
+	std::vector<Vector4> tangents(count);
+	for(size_t i = 0; i < count; ++i)
+	{
+		positions[i] = Vector3(distribution(random) * 10 + 5, distribution(random), 3);
+		normals[i] = Vector3(distribution(random), distribution(random), distribution(random)).Normalized();
+		tangents[i] = Vector4(normals[i][1], normals[i][2], normals[i][0], i % 2 ? 1.0f : -1.0f);
+	}
+	normals[0] = Vector3(0, 0, -1);
+	normals[1] = Vector3(1, 0, 0);
+
+	Mesh mesh(count);
+	mesh.SetAttributeData(VertexAttributeInfo::kPosition, positions.data(), count);
+	mesh.SetAttributeData(VertexAttributeInfo::kNormal, normals.data(), count);
+	mesh.SetAttributeData(VertexAttributeInfo::kVertexPrt0, tangents.data(), count);
+	const Matrix4 dequantization = MeshUtils::ReducePrecision(mesh, {
+		{VertexAttributeInfo::kPosition, MeshUtils::Quantization::kBoxUNorm16},
+		{VertexAttributeInfo::kNormal, MeshUtils::Quantization::kOctahedral16},
+		{VertexAttributeInfo::kVertexPrt0, MeshUtils::Quantization::kOctahedral8},
+		{VertexAttributeInfo::kSkinJoints, MeshUtils::Quantization::kInt8}
+	});
+
+	const auto& quantizedPositions = mesh.GetAttribute(VertexAttributeInfo::kPosition);
+	REQUIRE(quantizedPositions.GetType() == VertexAttributeInfo::kUInt16);
+	REQUIRE(quantizedPositions.GetRawSize() == count * 3 * 2);
+	const uint16_t* p = static_cast<const uint16_t*>(quantizedPositions.GetRawData());
+
+	const auto& quantizedNormals = mesh.GetAttribute(VertexAttributeInfo::kNormal);
+	REQUIRE(quantizedNormals.GetType() == VertexAttributeInfo::kInt16);
+	REQUIRE(quantizedNormals.GetNumComponents() == 2);
+	const int16_t* n = static_cast<const int16_t*>(quantizedNormals.GetRawData());
+
+	const auto& quantizedTangents = mesh.GetAttribute(VertexAttributeInfo::kVertexPrt0);
+	REQUIRE(quantizedTangents.GetType() == VertexAttributeInfo::kInt8);
+	REQUIRE(quantizedTangents.GetNumComponents() == 3);
+	const int8_t* t = static_cast<const int8_t*>(quantizedTangents.GetRawData());
+
+	for(size_t i = 0; i < count; ++i)
+	{
+		const Vector4 position = dequantization * Vector4(p[i * 3] / 65535.0f, p[i * 3 + 1] / 65535.0f, p[i * 3 + 2] / 65535.0f, 1.0f);
+		CHECK((Vector3(position[0], position[1], position[2]) - positions[i]).Length() < 0.001f);
+
+		const Vector3 normal = MeshUtils::OctahedralDecode(Vector2(n[i * 2] / 32767.0f, n[i * 2 + 1] / 32767.0f));
+		CHECK(normal.DotProduct(normals[i]) > 0.99999f);
+
+		const Vector3 tangent = MeshUtils::OctahedralDecode(Vector2(t[i * 3] / 127.0f, t[i * 3 + 1] / 127.0f));
+		CHECK(tangent.DotProduct(Vector3(tangents[i][0], tangents[i][1], tangents[i][2])) > 0.999f);
+		CHECK((t[i * 3 + 2] > 0) == (tangents[i][3] > 0));
+	}
+
+	Mesh integers(1);
+	const float values[] = {1, 2};
+	integers.SetAttributeData(VertexAttributeInfo::kSkinJoints, VertexAttributeInfo::kFloat, 2, values, sizeof(values));
+	CHECK_THROWS_AS(MeshUtils::ReducePrecision(integers, {{VertexAttributeInfo::kSkinJoints, MeshUtils::Quantization::kInt8}}), std::runtime_error);
+
+	// Errors leave all attributes unconverted:
+	const Hash valid[] = {VertexAttributeInfo::kPosition, VertexAttributeInfo::kNormal, VertexAttributeInfo::kVertexPrt0,
+			VertexAttributeInfo::kVertexPrt1, VertexAttributeInfo::kVertexPrt2};
+	std::unordered_map<Hash, MeshUtils::Quantization> modes = {{VertexAttributeInfo::kSkinJoints, MeshUtils::Quantization::kInt8}};
+	for(Hash name: valid)
+	{
+		integers.SetAttributeData(name, VertexAttributeInfo::kFloat, 3, positions.data(), 12);
+		modes[name] = MeshUtils::Quantization::kHalf;
+	}
+	CHECK_THROWS_AS(MeshUtils::ReducePrecision(integers, modes), std::runtime_error);
+	for(Hash name: valid)
+		CHECK(integers.GetAttribute(name).GetType() == VertexAttributeInfo::kFloat);
+
+	// Only one dequantization transform is returned:
+	CHECK_THROWS_AS(MeshUtils::ReducePrecision(integers, {
+			{VertexAttributeInfo::kPosition, MeshUtils::Quantization::kBoxUNorm16},
+			{VertexAttributeInfo::kNormal, MeshUtils::Quantization::kBoxUNorm16}}), std::runtime_error);
+	CHECK(integers.GetAttribute(VertexAttributeInfo::kPosition).GetType() == VertexAttributeInfo::kFloat);
+}
+
+TEST_CASE("TestEncodeIndices")
+{
+	// Grid in cache and fetch optimized order:
+	Mesh mesh = GenerateGrid(64).ToMesh();
+	std::vector<uint32_t>& indices = mesh.GetIndices();
+	MeshUtils::OptimizeVertexCache(mesh);
+	MeshUtils::OptimizeVertexFetch(mesh);
+
+	std::vector<uint8_t> encoded = MeshUtils::EncodeIndices(indices.data(), indices.size());
+	CHECK(encoded.size() < indices.size() / 2);
+	std::vector<uint32_t> decoded = {7};
+	MeshUtils::DecodeIndices(encoded.data(), encoded.size(), decoded);
+	REQUIRE(decoded.size() == indices.size() + 1);
+	CHECK(decoded.front() == 7);
+	decoded.erase(decoded.begin());
+	CHECK(CanonicalTriangles(decoded) == CanonicalTriangles(indices));
+
+	// Random triangles with large and degenerate indices:
+	std::mt19937 random(42);
+	std::vector<uint32_t> randomIndices(3000);
+	for(auto& index: randomIndices)
+		index = random() % 4 == 0 ? random() : random() % 100;
+	randomIndices[3] = randomIndices[4] = randomIndices[5];
+	encoded = MeshUtils::EncodeIndices(randomIndices.data(), randomIndices.size());
+	decoded.clear();
+	MeshUtils::DecodeIndices(encoded.data(), encoded.size(), decoded);
+	CHECK(CanonicalTriangles(decoded) == CanonicalTriangles(randomIndices));
+
+	encoded = MeshUtils::EncodeIndices(nullptr, 0);
+	decoded.clear();
+	MeshUtils::DecodeIndices(encoded.data(), encoded.size(), decoded);
+	CHECK(decoded.empty());
+
+	CHECK_THROWS_AS(MeshUtils::EncodeIndices(indices.data(), 4), std::range_error);
+	if(sizeof(size_t) > 4)
+		CHECK_THROWS_AS(MeshUtils::EncodeIndices(indices.data(), (size_t(1) << 32) * 3), std::range_error);
+	encoded = MeshUtils::EncodeIndices(randomIndices.data(), randomIndices.size());
+	CHECK_THROWS_AS(MeshUtils::DecodeIndices(encoded.data(), encoded.size() - 1, decoded), std::runtime_error);
+}
+
+TEST_CASE("TestEncodeVertexData")
+{
+	auto RoundTrip = [](const std::vector<uint8_t>& data, size_t elementSize)
+	{
+		const std::vector<uint8_t> encoded = MeshUtils::EncodeVertexData(data.data(), data.size(), elementSize);
+		std::vector<uint8_t> decoded;
+		MeshUtils::DecodeVertexData(encoded.data(), encoded.size(), decoded);
+		CHECK(decoded == data);
+		return encoded.size();
+	};
+
+	// Smooth float positions compress:
+	std::vector<float> positions;
+	for(int i = 0; i < 1000; ++i)
+	{
+		positions.push_back(std::sin(i * 0.01f));
+		positions.push_back(std::cos(i * 0.01f));
+		positions.push_back(i * 0.001f);
+	}
+	std::vector<uint8_t> bytes(positions.size() * sizeof(float));
+	std::memcpy(bytes.data(), positions.data(), bytes.size());
+	CHECK(RoundTrip(bytes, 12) < bytes.size());
+
+	// Random data, odd element size and a count that is not a multiple of the group size:
+	std::mt19937 random(42);
+	std::vector<uint8_t> randomBytes(6 * 301);
+	for(auto& byte: randomBytes)
+		byte = uint8_t(random());
+	RoundTrip(randomBytes, 6);
+	RoundTrip(std::vector<uint8_t>(randomBytes.begin(), randomBytes.begin() + 7), 1);
+	RoundTrip(std::vector<uint8_t>(), 4);
+
+	// Small deltas of all bit widths:
+	std::vector<uint8_t> ramp(4 * 517);
+	for(size_t i = 0; i < ramp.size(); ++i)
+		ramp[i] = uint8_t(i / 4 * (i % 4) + random() % (1 << (i % 4)));
+	RoundTrip(ramp, 4);
+
+	Mesh mesh(4);
+	const uint16_t texCoords[] = {0, 1, 2, 3, 4, 5, 6, 7};
+	mesh.SetAttributeData(VertexAttributeInfo::kTextureCoords, VertexAttributeInfo::kHalf, 2, texCoords, sizeof(texCoords));
+	const std::vector<uint8_t> encoded = MeshUtils::EncodeVertexData(mesh.GetAttribute(VertexAttributeInfo::kTextureCoords));
+	std::vector<uint8_t> decoded;
+	MeshUtils::DecodeVertexData(encoded.data(), encoded.size(), decoded);
+	REQUIRE(decoded.size() == sizeof(texCoords));
+	CHECK(std::memcmp(decoded.data(), texCoords, sizeof(texCoords)) == 0);
+
+	CHECK_THROWS_AS(MeshUtils::EncodeVertexData(bytes.data(), 10, 4), std::range_error);
+	CHECK_THROWS_AS(MeshUtils::EncodeVertexData(bytes.data(), 10, 0), std::range_error);
+	if(sizeof(size_t) > 4)
+		CHECK_THROWS_AS(MeshUtils::EncodeVertexData(bytes.data(), size_t(1) << 32, 1), std::range_error);
+
+	// A count that the remaining data cannot hold is rejected before allocating:
+	std::vector<uint8_t> inflated = {0xa1, 1, 0x80, 0x10};
+	inflated.resize(inflated.size() + 16, 0);
+	decoded.clear();
+	CHECK_THROWS_AS(MeshUtils::DecodeVertexData(inflated.data(), inflated.size(), decoded), std::runtime_error);
+	CHECK(decoded.empty());
+	inflated.resize(inflated.size() + 16, 0);
+	MeshUtils::DecodeVertexData(inflated.data(), inflated.size(), decoded);
+	CHECK(decoded == std::vector<uint8_t>(2048, 0));
+	const std::vector<uint8_t> encodedRandom = MeshUtils::EncodeVertexData(randomBytes.data(), randomBytes.size(), 6);
+	CHECK_THROWS_AS(MeshUtils::DecodeVertexData(encodedRandom.data(), encodedRandom.size() - 1, decoded), std::runtime_error);
+}
+
+TEST_CASE("TestInterleave")
+{
+	const unsigned int kNumVertices = 1500;
+	Mesh mesh(kNumVertices);
+	std::vector<Vector3> positions(kNumVertices);
+	std::vector<Vector2> texCoords(kNumVertices);
+	std::vector<uint8_t> colors(kNumVertices * 3);
+	std::vector<uint16_t> halves(kNumVertices * 4);
+	for(unsigned int i = 0; i < kNumVertices; ++i)
+	{
+		positions[i] = Vector3(i, i * 2.0f, i * 3.0f);
+		texCoords[i] = Vector2(i * 0.5f, -float(i));
+		for(int j = 0; j < 3; ++j)
+			colors[i * 3 + j] = uint8_t(i + j);
+		for(int j = 0; j < 4; ++j)
+			halves[i * 4 + j] = uint16_t(i * 4 + j);
+	}
+	mesh.SetAttributeData(VertexAttributeInfo::kPosition, positions.data(), positions.size());
+	mesh.SetAttributeData(VertexAttributeInfo::kTextureCoords, texCoords.data(), texCoords.size());
+	mesh.SetAttributeData(VertexAttributeInfo::kVertexPrt0, VertexAttributeInfo::kUInt8, 3, colors.data(), colors.size());
+	mesh.SetAttributeData(VertexAttributeInfo::kNormal, VertexAttributeInfo::kHalf, 4, halves.data(), halves.size() * 2);
+
+	const MeshUtils::InterleavedVertexData interleaved = MeshUtils::Interleave(mesh);
+	CHECK(interleaved.stride == 12 + 8 + 8 + 4);
+	REQUIRE(interleaved.data.size() == interleaved.stride * kNumVertices);
+	REQUIRE(interleaved.attributes.size() == 4);
+
+	// Floats first, ordered by name:
+	CHECK(interleaved.attributes[0].offset == 0);
+	CHECK(interleaved.attributes[1].offset == 8);
+	CHECK(interleaved.attributes[0].semantic == VertexAttributeInfo::kTextureCoords);
+	CHECK(interleaved.attributes[1].semantic == VertexAttributeInfo::kPosition);
+	CHECK(interleaved.attributes[2].semantic == VertexAttributeInfo::kNormal);
+	CHECK(interleaved.attributes[3].semantic == VertexAttributeInfo::kVertexPrt0);
+
+	for(auto& info: interleaved.attributes)
+	{
+		CHECK(info.stride == int(interleaved.stride));
+		CHECK(info.offset % 4 == 0);
+		const Mesh::Attribute& attribute = mesh.GetAttribute(info.semantic);
+		const size_t size = VertexAttributeInfo::GetTypeSize(info.type) * info.components;
+		for(unsigned int i = 0; i < kNumVertices; ++i)
+		{
+			const uint8_t* expected = static_cast<const uint8_t*>(attribute.GetRawData()) + i * size;
+			REQUIRE(std::memcmp(interleaved.data.data() + i * info.stride + info.offset, expected, size) == 0);
+		}
+	}
+	CHECK(interleaved.data[interleaved.attributes[3].offset + 3] == 0);
+
+	CHECK(MeshUtils::Interleave(mesh, 16).stride == 64);
+	CHECK_THROWS_AS(MeshUtils::Interleave(mesh, 3), std::range_error);
+	CHECK(MeshUtils::Interleave(Mesh(10)).data.empty());
+}
+
+TEST_CASE("TestInterleaveNormalized")
+{
+	// Integer joint indices stay integers, quantized normals and positions are normalized:
+	Mesh mesh(2);
+	const Vector3 positions[] = {{0, 0, 0}, {1, 2, 3}};
+	const Vector3 normals[] = {{0, 0, 1}, {1, 0, 0}};
+	const IntVector4 joints[] = {{3, 1, 0, 0}, {2, 0, 0, 0}};
+	mesh.SetAttributeData(VertexAttributeInfo::kPosition, positions, 2);
+	mesh.SetAttributeData(VertexAttributeInfo::kNormal, normals, 2);
+	mesh.SetAttributeData(VertexAttributeInfo::kSkinJoints, joints, 2);
+	mesh.SetAttributeData(VertexAttributeInfo::kTextureCoords, VertexAttributeInfo::kFloat, 1, positions, 2 * sizeof(float));
+
+	MeshUtils::ReducePrecision(mesh, {
+			{VertexAttributeInfo::kPosition, MeshUtils::Quantization::kBoxUNorm16},
+			{VertexAttributeInfo::kNormal, MeshUtils::Quantization::kOctahedral8},
+			{VertexAttributeInfo::kSkinJoints, MeshUtils::Quantization::kInt8}});
+	const MeshUtils::InterleavedVertexData interleaved = MeshUtils::Interleave(mesh);
+	REQUIRE(interleaved.attributes.size() == 4);
+	for(auto& info: interleaved.attributes)
+	{
+		if(info.semantic == VertexAttributeInfo::kSkinJoints)
+		{
+			CHECK(info.type == VertexAttributeInfo::kInt8);
+			CHECK_FALSE(info.normalized);
+		}
+		else if(info.semantic == VertexAttributeInfo::kTextureCoords)
+			CHECK_FALSE(info.normalized);
+		else
+			CHECK(info.normalized);
+	}
+}
+
+TEST_CASE("TestStridedViewAlgorithms")
+{
+	// Quad in the XY plane with texture coordinates, interleaved:
+	Mesh mesh(4);
+	const Vector3 positions[] = {Vector3(0, 0, 0), Vector3(1, 0, 0), Vector3(1, 1, 0), Vector3(0, 1, 0)};
+	const Vector3 normals[] = {Vector3(0, 0, 0), Vector3(0, 0, 0), Vector3(0, 0, 0), Vector3(0, 0, 0)};
+	const Vector2 texCoords[] = {Vector2(0, 0), Vector2(1, 0), Vector2(1, 1), Vector2(0, 1)};
+	mesh.SetAttributeData(VertexAttributeInfo::kPosition, positions, 4);
+	mesh.SetAttributeData(VertexAttributeInfo::kNormal, normals, 4);
+	mesh.SetAttributeData(VertexAttributeInfo::kTextureCoords, texCoords, 4);
+	MeshUtils::InterleavedVertexData interleaved = MeshUtils::Interleave(mesh);
+
+	StridedView<Vector3> positionView, normalView;
+	StridedView<Vector2> texCoordView;
+	for(auto& info: interleaved.attributes)
+	{
+		if(info.semantic == VertexAttributeInfo::kPosition)
+			positionView = StridedView<Vector3>(interleaved.data.data(), info, 4);
+		else if(info.semantic == VertexAttributeInfo::kNormal)
+			normalView = StridedView<Vector3>(interleaved.data.data(), info, 4);
+		else
+			texCoordView = StridedView<Vector2>(interleaved.data.data(), info, 4);
+	}
+	REQUIRE(positionView.size() == 4);
+	CHECK(positionView.GetStride() == interleaved.stride);
+	CHECK(positionView[2][0] == 1);
+	CHECK(positionView[2][1] == 1);
+
+	const int indices[] = {0, 1, 2, 0, 2, 3};
+	MeshUtils::IndexedTriangleNormals(positionView, indices, 2, normalView);
+	for(auto& normal: normalView)
+		CHECK(normal[2] == Catch::Approx(1.0f));
+
+	MeshUtils::Scale(positionView, 2.0f);
+	CHECK(positionView[2][0] == 2);
+	MeshUtils::Transform(positionView, normalView, Matrix4::Translation(Vector3(1, 0, 0)));
+	CHECK(positionView[2][0] == Catch::Approx(3.0f));
+	CHECK(positionView[0][0] == Catch::Approx(1.0f));
+	CHECK(normalView[1][2] == Catch::Approx(1.0f));
+
+	// Other attributes are untouched:
+	CHECK(texCoordView[2][0] == 1);
+	CHECK(texCoordView[3][1] == 1);
+
+	// Mesh overloads work on the non-interleaved data:
+	MeshUtils::Transform(mesh, Matrix4::Scale(1, 1, 1));
+	CHECK(mesh.GetAttribute(VertexAttributeInfo::kPosition).GetView<Vector3>()[2][1] == 1);
+	CHECK(mesh.GetAttribute(VertexAttributeInfo::kNormal).GetView<Vector3>()[0][2] == 0);
+	CHECK_THROWS_AS(MeshUtils::IndexedTriangleNormals(positionView, indices, 2, StridedView<Vector3>()), std::range_error);
+}
+
+TEST_CASE("TestMeshAttributeOwnership")
+{
+	Mesh mesh(2);
+	std::vector<uint8_t> bytes = {1, 2, 3, 4, 5, 6};
+	const uint8_t* pointer = bytes.data();
+	mesh.SetAttributeData(VertexAttributeInfo::kVertexPrt0, VertexAttributeInfo::kUInt8, 3, std::move(bytes));
+	CHECK(mesh.GetAttribute(VertexAttributeInfo::kVertexPrt0).GetRawData() == pointer);
+	CHECK(mesh.GetAttribute(VertexAttributeInfo::kVertexPrt0).GetRawSize() == 6);
+
+	Blob blob(2 * sizeof(Vector2));
+	const void* blobPointer = blob.GetData();
+	mesh.SetAttributeData(VertexAttributeInfo::kTextureCoords, VertexAttributeInfo::kFloat, 2, std::move(blob));
+	const Mesh::Attribute& texCoords = mesh.GetAttribute(VertexAttributeInfo::kTextureCoords);
+	CHECK(texCoords.GetRawData() == blobPointer);
+	CHECK(texCoords.GetView<Vector2>().size() == 2);
+
+	// Moving the mesh keeps the buffers:
+	MeshSet meshes;
+	meshes.push_back(std::move(mesh));
+	CHECK(meshes[0].GetAttribute(VertexAttributeInfo::kVertexPrt0).GetRawData() == pointer);
+
+	Mesh& attributeOwner = meshes[0];
+	attributeOwner.GetAttribute(VertexAttributeInfo::kVertexPrt0).SetData(VertexAttributeInfo::kUInt8, 3, std::vector<uint8_t>{7, 8, 9, 10, 11, 12});
+	CHECK(static_cast<const uint8_t*>(attributeOwner.GetAttribute(VertexAttributeInfo::kVertexPrt0).GetRawData())[5] == 12);
+}
+
+TEST_CASE("TestMeshArena")
+{
+	MeshSet meshes;
+	for(unsigned int m = 0; m < 3; ++m)
+	{
+		Mesh mesh(3 + m);
+		std::vector<Vector3> positions;
+		std::vector<uint16_t> halves;
+		for(unsigned int i = 0; i < 3 + m; ++i)
+		{
+			positions.push_back(Vector3(m, i, 1));
+			halves.push_back(uint16_t(m * 100 + i));
+		}
+		mesh.SetAttributeData(VertexAttributeInfo::kPosition, positions.data(), positions.size());
+		mesh.SetAttributeData(VertexAttributeInfo::kVertexPrt0, VertexAttributeInfo::kHalf, 1, halves.data(), halves.size() * 2);
+		mesh.GetIndices() = {0, 1, 2};
+		mesh.SetMaterial("material" + std::to_string(m));
+		meshes.push_back(std::move(mesh));
+	}
+
+	MeshArena arena(meshes);
+	REQUIRE(arena.GetIndexBufferInfos().size() == 3);
+	REQUIRE(arena.GetVertexAttributeInfos().size() == 3);
+	const uint8_t* begin = static_cast<const uint8_t*>(arena.GetData());
+	const uint8_t* end = begin + arena.GetSize();
+	for(size_t m = 0; m < 3; ++m)
+	{
+		const IndexBufferInfo& indexInfo = arena.GetIndexBufferInfos()[m];
+		CHECK(indexInfo.offset % 16 == 0);
+		CHECK(indexInfo.count == 3);
+		CHECK(indexInfo.vertexDataSet == m);
+		CHECK(std::string(indexInfo.material) == "material" + std::to_string(m));
+		CHECK(std::memcmp(begin + indexInfo.offset, meshes[m].GetIndices().data(), 12) == 0);
+
+		for(auto& info: arena.GetVertexAttributeInfos()[m])
+		{
+			const Mesh::Attribute& attribute = meshes[m].GetAttribute(info.semantic);
+			CHECK(attribute.IsInArena());
+			CHECK(attribute.GetRawData() == begin + info.offset);
+			CHECK(begin + info.offset + attribute.GetRawSize() <= end);
+			CHECK(info.offset % 16 == 0);
+		}
+		const StridedView<const Vector3> positions = meshes[m].GetAttribute(VertexAttributeInfo::kPosition).GetView<Vector3>();
+		REQUIRE(positions.size() == 3 + m);
+		CHECK(positions[2][0] == m);
+		CHECK(positions[2][1] == 2);
+	}
+
+	// Algorithms keep working on arena data and make the attribute own it again:
+	MeshUtils::OptimizeVertexFetch(meshes[1]);
+	CHECK_FALSE(meshes[1].GetAttribute(VertexAttributeInfo::kPosition).IsInArena());
+	CHECK(meshes[1].GetAttribute(VertexAttributeInfo::kPosition).GetView<Vector3>()[0][0] == 1);
+
+	MeshArena moved(std::move(arena));
+	CHECK(moved.GetVertexAttributeInfos()[2].back().semantic == VertexAttributeInfo::kPosition);
+	CHECK(meshes[2].GetAttribute(VertexAttributeInfo::kPosition).GetRawData() == static_cast<const uint8_t*>(moved.GetData()) + moved.GetVertexAttributeInfos()[2].back().offset);
+	CHECK_THROWS_AS(MeshArena(meshes, 3), std::range_error);
+}
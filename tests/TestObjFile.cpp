@@ -0,0 +1,668 @@
+/*	TestObjFile.cpp
+
+MIT License
+
+Copyright (c) 2026 Fabian Herb
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <catch2/catch_test_macros.hpp>
+#include <molecular/util/ObjFile.h>
+#include <molecular/util/ObjFileUtils.h>
+#include <molecular/util/ObjTokenizer.h>
+#include <molecular/util/MemoryStreamStorage.h>
+#include <molecular/util/FileStreamStorage.h>
+#include <molecular/testbed/Matchers.h>
+
+#include <cmath>
+#include <sstream>
+
+using namespace Catch;
+using namespace molecular::util;
+using namespace molecular::testbed;
+
+namespace
+{
+
+ObjFile LoadObj(const std::string& text)
+{
+	MemoryReadStorage storage(text.data(), text.size());
+	TextReadStream<MemoryReadStorage> stream(storage);
+	return ObjFile(stream);
+}
+
+template<int vertices>
+bool FacesEqual(const std::vector<ObjFile::Face<vertices>>& a, const std::vector<ObjFile::Face<vertices>>& b)
+{
+	if(a.size() != b.size())
+		return false;
+	for(size_t i = 0; i < a.size(); ++i)
+	{
+		if(a[i].vertexIndices != b[i].vertexIndices
+				|| a[i].texCoordIndices != b[i].texCoordIndices
+				|| a[i].normalIndices != b[i].normalIndices)
+			return false;
+	}
+	return true;
+}
+
+}
+
+TEST_CASE("TestObjTokenizerNumbers")
+{
+	const char text[] = "-12.5e-1 3 .25 +7 x";
+	const char* it = text;
+	const char* end = text + sizeof(text) - 1;
+	float f = 0;
+	int32_t i = 0;
+
+	CHECK(ObjTokenizer::ParseFloat(it, end, f));
+	CHECK(f == Approx(-1.25));
+	CHECK(*it == ' ');
+	CHECK(ObjTokenizer::ParseInt(++it, end, i));
+	CHECK(i == 3);
+	CHECK(ObjTokenizer::ParseFloat(++it, end, f));
+	CHECK(f == Approx(0.25));
+	CHECK(ObjTokenizer::ParseInt(++it, end, i));
+	CHECK(i == 7);
+	++it;
+	CHECK_FALSE(ObjTokenizer::ParseFloat(it, end, f));
+	CHECK_FALSE(ObjTokenizer::ParseInt(it, end, i));
+	CHECK(*it == 'x');
+}
+
+TEST_CASE("TestObjFileFaceFormats")
+{
+	const std::string text =
+			"# comment\n"
+			"mtllib test.mtl\n"
+			"v 0 0 0\n"
+			"v 1 0 0\n"
+			"v 1 1 0\n"
+			"v 0 1 0\n"
+			"vt 0 0\n"
+			"vt 1 0.25\n"
+			"vt 1 1\n"
+			"vn 0 0 1\n"
+			"g positions\n"
+			"usemtl red\n"
+			"f 1 2 3\n"
+			"f 1 2 3 4\n"
+			"g texcoords\n"
+			"f 1/1 2/2 3/3\r\n"
+			"g all\n"
+			"f 1/1/1 2/2/1 3/3/1 4/3/1\n"
+			"g normals\n"
+			"f 1//1 2//1 -2//1\n";
+	ObjFile obj = LoadObj(text);
+
+	REQUIRE(obj.GetVertices().size() == 4);
+	REQUIRE(obj.GetTexCoords().size() == 3);
+	REQUIRE(obj.GetNormals().size() == 1);
+	CHECK_THAT(obj.GetTexCoords()[1], EqualsApprox(Vector2(1, 0.75)));
+	CHECK_THAT(obj.GetBoundingBox().GetMax(), EqualsApprox(Vector3(1, 1, 0)));
+
+	auto& groups = obj.GetVertexGroups();
+	REQUIRE(groups.size() == 4);
+	CHECK(groups[0].name == "positions");
+	CHECK(groups[0].material == "red");
+	CHECK(groups[0].numTriangles == 1);
+	CHECK(groups[0].numQuads == 1);
+	CHECK_FALSE(groups[0].hasNormals);
+	CHECK_FALSE(groups[0].hasTexCoords);
+
+	CHECK(groups[1].name == "texcoords");
+	CHECK(groups[1].material.empty()); // usemtl was consumed by the first group
+	CHECK(groups[1].hasTexCoords);
+	CHECK_FALSE(groups[1].hasNormals);
+
+	CHECK(groups[2].firstQuad == 1);
+	CHECK(groups[2].numQuads == 1);
+	CHECK(groups[2].hasTexCoords);
+	CHECK(groups[2].hasNormals);
+
+	CHECK(groups[3].firstTriangle == 2);
+	CHECK(groups[3].hasNormals);
+	CHECK_FALSE(groups[3].hasTexCoords);
+
+	REQUIRE(obj.GetTriangles().size() == 3);
+	auto& tri = obj.GetTriangles()[2];
+	CHECK(tri.vertexIndices[0] == 0);
+	CHECK(tri.vertexIndices[2] == 2); // Relative index -2
+	CHECK(tri.normalIndices[1] == 0);
+
+	auto& quad = obj.GetQuads()[1];
+	CHECK(quad.vertexIndices[3] == 3);
+	CHECK(quad.texCoordIndices[3] == 2);
+	CHECK(quad.normalIndices[3] == 0);
+}
+
+TEST_CASE("TestObjFileMaterialGroups")
+{
+	const std::string text =
+			"v 0 0 0\n"
+			"v 1 0 0\n"
+			"v 1 1 0\n"
+			"o object\n"
+			"usemtl first\n"
+			"f 1 2 3\n"
+			"usemtl second\n"
+			"f 1 2 3\n"
+			"f 3 2 1\n";
+	ObjFile obj = LoadObj(text);
+
+	auto& groups = obj.GetVertexGroups();
+	REQUIRE(groups.size() == 2);
+	CHECK(groups[0].name == "object");
+	CHECK(groups[0].material == "first");
+	CHECK(groups[0].numTriangles == 1);
+	CHECK(groups[1].name == "second");
+	CHECK(groups[1].material == "second");
+	CHECK(groups[1].firstTriangle == 1);
+	CHECK(groups[1].numTriangles == 2);
+}
+
+TEST_CASE("TestObjFileErrors")
+{
+	CHECK_THROWS(LoadObj("v 0 0 0\nf 1 1 1\n"));
+	CHECK_THROWS(LoadObj("v 0 0 0\ng group\nf 1 1 2\n"));
+
+	// Index 0 and relative indices before the start of the list:
+	const std::string vertices = "v 0 0 0\nv 1 0 0\nv 0 1 0\nvt 0 0\nvn 0 0 1\ng group\n";
+	CHECK_NOTHROW(ObjFile(vertices + "f -3 -2 -1\n"));
+	CHECK_THROWS_AS(ObjFile(vertices + "f 0 1 2\n"), std::runtime_error);
+	CHECK_THROWS_AS(ObjFile(vertices + "f -4 1 2\n"), std::runtime_error);
+	CHECK_THROWS_AS(ObjFile(vertices + "f -9 1 2\n"), std::runtime_error);
+
+	// Texture coordinates and normals are checked as well:
+	CHECK_NOTHROW(ObjFile(vertices + "f 1/1/1 2/1/1 3/-1/-1\n"));
+	CHECK_THROWS_AS(ObjFile(vertices + "f 1/99/1 2/1/1 3/1/1\n"), std::runtime_error);
+	CHECK_THROWS_AS(ObjFile(vertices + "f 1/1/99 2/1/1 3/1/1\n"), std::runtime_error);
+	CHECK_THROWS_AS(ObjFile(vertices + "f 1//2 2//1 3//1\n"), std::runtime_error);
+	CHECK_THROWS_AS(ObjFile(vertices + "f 1/0 2/1 3/1\n"), std::runtime_error);
+	CHECK_THROWS_AS(ObjFile(vertices + "f 1/-2 2/1 3/1\n"), std::runtime_error);
+	CHECK_THROWS_AS(ObjFile32(vertices + "f 1/1/99 2/1/1 3/1/1\n"), std::runtime_error);
+}
+
+TEST_CASE("TestObjFileFromMemory")
+{
+	std::string longName(2000, 'x'); // Exceeds the line buffer of TextReadStream
+	const std::string text =
+			"v 0 0 0\r\n"
+			"v 1 0 0\n"
+			"v 1 1 0\n"
+			"\n"
+			"g " + longName + "\n"
+			"f 1 2 3"; // No newline at the end
+
+	ObjFile obj(text);
+	REQUIRE(obj.GetVertices().size() == 3);
+	REQUIRE(obj.GetVertexGroups().size() == 1);
+	CHECK(obj.GetVertexGroups()[0].name == longName);
+	CHECK(obj.GetTriangles().size() == 1);
+
+	const std::string fileName = "TestObjFileFromMemory.obj";
+	{
+		FileWriteStorage storage(fileName);
+		storage.Write(text.data(), text.size());
+	}
+	{
+		MappedFile file(fileName);
+		CHECK(file.GetSize() == text.size());
+		ObjFile mappedObj(file);
+		CHECK(mappedObj.GetVertices().size() == 3);
+		CHECK(mappedObj.GetTriangles().size() == 1);
+	}
+	std::remove(fileName.c_str());
+}
+
+TEST_CASE("TestObjFileParallel")
+{
+	// Large enough to be split into several chunks:
+	std::ostringstream text;
+	text << "mtllib test.mtl\n";
+	for(int i = 0; i < 40000; ++i)
+	{
+		text << "v " << i << " " << i * 0.5f << " " << -i << "\n";
+		text << "vt " << i * 0.25f << " 0.5\n";
+		if(i % 3 == 0)
+			text << "vn 0 0 1\n";
+		if(i % 1000 == 0)
+			text << "g group" << i << "\n";
+		if(i % 1500 == 0)
+			text << "usemtl material" << i << "\n";
+		if(i % 7000 == 0)
+			text << "o object" << i << "\n";
+		if(i >= 3)
+		{
+			if(i % 5 == 0)
+				text << "f " << i << "/" << i << " " << i - 1 << "/" << i - 1 << " -1/-1 " << i - 2 << "/" << i - 2 << "\n";
+			else if(i % 5 == 1)
+				text << "f " << i << "//1 " << i - 1 << "//1 " << i - 2 << "//-1\n";
+			else
+				text << "f -1/-1/-1 -2/-2/-1 -3/-3/-1\n";
+		}
+	}
+	const std::string str = text.str();
+	REQUIRE(str.size() > (2 << 20));
+
+	ObjFile serial(str);
+	TaskDispatcher dispatcher;
+	ObjFile parallel(str, dispatcher);
+
+	CHECK(serial.GetVertices() == parallel.GetVertices());
+	CHECK(serial.GetTexCoords() == parallel.GetTexCoords());
+	CHECK(serial.GetNormals() == parallel.GetNormals());
+	CHECK(FacesEqual(serial.GetTriangles(), parallel.GetTriangles()));
+	CHECK(FacesEqual(serial.GetQuads(), parallel.GetQuads()));
+	CHECK(serial.GetBoundingBox().GetMin() == parallel.GetBoundingBox().GetMin());
+	CHECK(serial.GetBoundingBox().GetMax() == parallel.GetBoundingBox().GetMax());
+
+	auto& serialGroups = serial.GetVertexGroups();
+	auto& parallelGroups = parallel.GetVertexGroups();
+	REQUIRE(serialGroups.size() == parallelGroups.size());
+	for(size_t i = 0; i < serialGroups.size(); ++i)
+	{
+		CHECK(serialGroups[i].name == parallelGroups[i].name);
+		CHECK(serialGroups[i].material == parallelGroups[i].material);
+		CHECK(serialGroups[i].firstTriangle == parallelGroups[i].firstTriangle);
+		CHECK(serialGroups[i].numTriangles == parallelGroups[i].numTriangles);
+		CHECK(serialGroups[i].firstQuad == parallelGroups[i].firstQuad);
+		CHECK(serialGroups[i].numQuads == parallelGroups[i].numQuads);
+		CHECK(serialGroups[i].hasNormals == parallelGroups[i].hasNormals);
+		CHECK(serialGroups[i].hasTexCoords == parallelGroups[i].hasTexCoords);
+	}
+
+	CHECK_THROWS(ObjFile(str + "f 1 2 99999999\n", dispatcher));
+}
+
+TEST_CASE("TestObjFileWideIndices")
+{
+	std::ostringstream text;
+	for(int i = 0; i < 70000; ++i)
+		text << "v " << i << " 0 0\n";
+	text << "g group\n";
+	text << "f 1 2 3\n";
+	text << "f 69998 69999 70000\n";
+	const std::string str = text.str();
+
+	CHECK(ObjFileUtils::RequiresWideIndices(str));
+	CHECK_FALSE(ObjFileUtils::RequiresWideIndices("v 0 0 0\nv 1 1 1\nf 1 2 1\n"));
+	CHECK_THROWS_AS(ObjFile(str), std::range_error);
+
+	ObjFile32 obj(str);
+	REQUIRE(obj.GetTriangles().size() == 2);
+	CHECK(obj.GetTriangles()[1].vertexIndices[2] == 69999);
+
+	size_t indexSize = 0;
+	ObjFileUtils::ParseWithFittingIndexType(str, [&](const auto& objFile)
+	{
+		indexSize = sizeof(typename std::decay_t<decltype(objFile)>::Index);
+		CHECK(objFile.GetVertices().size() == 70000);
+	});
+	CHECK(indexSize == 4);
+}
+
+TEST_CASE("TestObjFileIndexTypeBoundary")
+{
+	// 0xffff marks absent texture coordinates and normals, so it is no valid vertex index:
+	auto vertices = [](int count)
+	{
+		std::ostringstream text;
+		for(int i = 0; i < count; ++i)
+			text << "v " << i << " 0 0\n";
+		text << "g group\n";
+		text << "f 1 2 " << count << "\n";
+		return text.str();
+	};
+
+	const std::string fits = vertices(65535);
+	CHECK_FALSE(ObjFileUtils::RequiresWideIndices(fits));
+	ObjFile obj(fits);
+	REQUIRE(obj.GetTriangles().size() == 1);
+	CHECK(obj.GetTriangles()[0].vertexIndices[2] == 65534);
+
+	const std::string exceeds = vertices(65536);
+	CHECK(ObjFileUtils::RequiresWideIndices(exceeds));
+	CHECK_THROWS_AS(ObjFile(exceeds), std::range_error);
+	CHECK(ObjFile32(exceeds).GetTriangles()[0].vertexIndices[2] == 65535);
+}
+
+TEST_CASE("TestObjFileTriangulate")
+{
+	const std::string text =
+			"v 0 0 0\n"
+			"v 1 0 0\n"
+			"v 2 1 0\n"
+			"v 1 2 0\n"
+			"v 0 1 0\n"
+			"vt 0 0\n"
+			"g polygons\n"
+			"f 1/1 2/1 3/1 4/1 5/1\n"
+			"f 1/1 2/1 3/1 4/1\n"
+			"f 1/1 2/1 3/1\n";
+
+	ObjFile quads(text);
+	CHECK(quads.GetQuads().size() == 2); // Pentagon is cut off
+	CHECK(quads.GetTriangles().size() == 1);
+
+	ObjFile triangulated(text, 1.0f, ObjPolygonMode::kTriangulate);
+	CHECK(triangulated.GetQuads().empty());
+	REQUIRE(triangulated.GetTriangles().size() == 6);
+	auto& group = triangulated.GetVertexGroups().at(0);
+	CHECK(group.numTriangles == 6);
+	CHECK(group.numQuads == 0);
+	auto& fan = triangulated.GetTriangles();
+	CHECK(fan[2].vertexIndices == std::array<uint16_t, 3>{0, 3, 4});
+	CHECK(fan[2].texCoordIndices == std::array<uint16_t, 3>{0, 0, 0});
+
+	// Quads must result in the same buffers:
+	std::vector<uint32_t> quadIndices, triangulatedIndices;
+	std::vector<Vector3> quadPositions, triangulatedPositions, normals;
+	std::vector<Vector2> quadUvs, triangulatedUvs;
+	ObjFile quadsOnly(text.substr(0, text.find("f 1/1 2/1 3/1 4/1 5/1")) + "f 1/1 2/1 3/1 4/1\n");
+	ObjFile quadsTriangulated(text.substr(0, text.find("f 1/1 2/1 3/1 4/1 5/1")) + "f 1/1 2/1 3/1 4/1\n", 1.0f, ObjPolygonMode::kTriangulate);
+	ObjFileUtils::ObjVertexGroupBuffers(quadsOnly, quadsOnly.GetVertexGroups()[0], quadIndices, quadPositions, normals, quadUvs);
+	ObjFileUtils::ObjVertexGroupBuffers(quadsTriangulated, quadsTriangulated.GetVertexGroups()[0], triangulatedIndices, triangulatedPositions, normals, triangulatedUvs);
+	CHECK(quadIndices.size() == 6);
+	CHECK(quadIndices == triangulatedIndices);
+	CHECK(quadPositions == triangulatedPositions);
+	CHECK(quadUvs == triangulatedUvs);
+}
+
+TEST_CASE("TestObjFileStreamMeshes")
+{
+	const std::string text =
+			"v 0 0 0\n"
+			"v 1 0 0\n"
+			"v 1 1 0\n"
+			"v 0 1 0\n"
+			"vt 0 0\n"
+			"vt 1 1\n"
+			"vn 0 0 1\n"
+			"g empty\n"
+			"g quad\n"
+			"usemtl first\n"
+			"f 1/1/1 2/1/1 3/2/1 4/2/1\n"
+			"usemtl second\n"
+			"f 1//1 2//1 3//1\n"
+			"f -1//1 -2//1 -3//1\n";
+
+	std::vector<std::string> names;
+	std::vector<Mesh> meshes;
+	auto collect = [&](const std::string& name, Mesh&& mesh)
+	{
+		names.push_back(name);
+		meshes.push_back(std::move(mesh));
+	};
+	ObjFileUtils::StreamMeshes(text, collect, 2.0f);
+
+	REQUIRE(meshes.size() == 2);
+	CHECK(names[0] == "quad");
+	CHECK(meshes[0].GetMaterial() == "first");
+	CHECK(meshes[0].GetIndices() == std::vector<uint32_t>{0, 1, 2, 0, 2, 3});
+	CHECK(meshes[0].GetNumVertices() == 4);
+	CHECK(meshes[0].GetAttributes().count(VertexAttributeInfo::kTextureCoords) == 1);
+	CHECK(meshes[0].GetAttributes().count(VertexAttributeInfo::kNormal) == 1);
+
+	CHECK(names[1] == "second");
+	CHECK(meshes[1].GetMaterial() == "second");
+	CHECK(meshes[1].GetIndices() == std::vector<uint32_t>{0, 1, 2, 3, 2, 1});
+	CHECK(meshes[1].GetNumVertices() == 4);
+	CHECK(meshes[1].GetAttributes().count(VertexAttributeInfo::kTextureCoords) == 0);
+
+	// Same result from a stream:
+	MemoryReadStorage storage(text.data(), text.size());
+	TextReadStream<MemoryReadStorage> stream(storage);
+	std::vector<Mesh> streamed;
+	ObjFileUtils::StreamMeshes(stream, [&](const std::string&, Mesh&& mesh){streamed.push_back(std::move(mesh));}, 2.0f);
+	REQUIRE(streamed.size() == 2);
+	CHECK(streamed[1].GetIndices() == meshes[1].GetIndices());
+
+	CHECK_THROWS_AS(ObjFileUtils::StreamMeshes("v 0 0 0\nf 1 1 1\n", collect), std::runtime_error);
+	CHECK_THROWS_AS(ObjFileUtils::StreamMeshes("v 0 0 0\ng g\nf 1 2 3\n", collect), std::runtime_error);
+
+	// Texture coordinates and normals declared after the face are rejected, like ObjFile does:
+	const std::string late = "v 0 0 0\ng g\nf 1/1 1/1 1/1\nvt 0 0\n";
+	CHECK_THROWS_AS(ObjFileUtils::StreamMeshes(late, collect), std::runtime_error);
+	CHECK_THROWS_AS(ObjFile(std::string_view(late)), std::runtime_error);
+	CHECK_THROWS_AS(ObjFileUtils::StreamMeshes("v 0 0 0\ng g\nf 1//1 1//1 1//1\nvn 0 0 1\n", collect), std::runtime_error);
+}
+
+TEST_CASE("TestObjFileCache")
+{
+	const std::string text =
+			"mtllib scene.mtl\n"
+			"v 0 0 0\n"
+			"v 1 0 0\n"
+			"v 1 1 0\n"
+			"v 0 1 0\n"
+			"vt 0 0\n"
+			"vn 0 0 1\n"
+			"g quad\n"
+			"usemtl stone\n"
+			"f 1/1/1 2/1/1 3/1/1 4/1/1\n"
+			"g triangle\n"
+			"f 1 2 3\n";
+	const std::string fileName = "TestObjFileCache.obj";
+	const std::string cacheName = "TestObjFileCache.obj.cache";
+	auto writeFile = [](const std::string& name, const std::string& contents)
+	{
+		FileWriteStorage storage(name);
+		storage.Write(contents.data(), contents.size());
+	};
+	writeFile(fileName, text);
+	std::remove(cacheName.c_str());
+
+	ObjFile parsed = ObjFile::LoadCached(fileName, cacheName, 2.0f);
+	const ObjFile::CacheSource source(text.data(), text.size());
+	{
+		MappedFile cache(cacheName);
+		ObjFile::CacheSource otherHash = source;
+		otherHash.hash++;
+		ObjFile::CacheSource otherSize = source;
+		otherSize.size++;
+		CHECK_FALSE(ObjFile::FromCache(cache.GetData(), cache.GetSize(), otherHash, 2.0f));
+		CHECK_FALSE(ObjFile::FromCache(cache.GetData(), cache.GetSize(), otherSize, 2.0f));
+		CHECK_FALSE(ObjFile::FromCache(cache.GetData(), cache.GetSize(), source, 1.0f));
+		CHECK_FALSE(ObjFile32::FromCache(cache.GetData(), cache.GetSize(), ObjFile32::CacheSource(text.data(), text.size()), 2.0f));
+		CHECK_FALSE(ObjFile::FromCache(cache.GetData(), cache.GetSize() - 1, source, 2.0f));
+
+		// Face indices outside the loaded arrays make the cache invalid:
+		const std::string bytes(static_cast<const char*>(cache.GetData()), cache.GetSize());
+		const std::string quadVertices("\0\0\1\0\2\0\3\0", 8);
+		const size_t quad = bytes.find(quadVertices);
+		REQUIRE(quad != std::string::npos);
+		std::string corrupt = bytes;
+		corrupt[quad + 6] = 99;
+		CHECK_FALSE(ObjFile::FromCache(corrupt.data(), corrupt.size(), source, 2.0f));
+		corrupt = bytes;
+		corrupt[quad + 8] = 1; // Texture coordinate
+		CHECK_FALSE(ObjFile::FromCache(corrupt.data(), corrupt.size(), source, 2.0f));
+		corrupt = bytes;
+		corrupt[quad + 16] = 5; // Normal
+		CHECK_FALSE(ObjFile::FromCache(corrupt.data(), corrupt.size(), source, 2.0f));
+		CHECK(ObjFile::FromCache(bytes.data(), bytes.size(), source, 2.0f));
+
+		auto cached = ObjFile::FromCache(cache.GetData(), cache.GetSize(), source, 2.0f);
+		REQUIRE(cached);
+		CHECK(cached->GetVertices() == parsed.GetVertices());
+		CHECK(cached->GetTexCoords().size() == 1);
+		CHECK(cached->GetNormals().size() == 1);
+		CHECK(FacesEqual(cached->GetQuads(), parsed.GetQuads()));
+		CHECK(FacesEqual(cached->GetTriangles(), parsed.GetTriangles()));
+		CHECK(cached->GetBoundingBox().GetMax() == parsed.GetBoundingBox().GetMax());
+		REQUIRE(cached->GetVertexGroups().size() == 2);
+		CHECK(cached->GetVertexGroups()[0].name == "quad");
+		CHECK(cached->GetVertexGroups()[0].material == "stone");
+		CHECK(cached->GetVertexGroups()[0].hasNormals);
+		CHECK(cached->GetVertexGroups()[1].name == "triangle");
+		CHECK(cached->GetVertexGroups()[1].firstTriangle == 0);
+		CHECK_FALSE(cached->GetVertexGroups()[1].hasNormals);
+	}
+
+	// Changed source invalidates the cache. The old cache is replaced, not overwritten:
+	MappedFile oldCache(cacheName);
+	const std::string oldCacheData(static_cast<const char*>(oldCache.GetData()), oldCache.GetSize());
+	writeFile(fileName, text + "f 2 3 4\n");
+	ObjFile changed = ObjFile::LoadCached(fileName, cacheName, 2.0f);
+	CHECK(changed.GetTriangles().size() == 2);
+	CHECK(std::string(static_cast<const char*>(oldCache.GetData()), oldCache.GetSize()) == oldCacheData);
+	CHECK(ObjFile::FromCache(oldCache.GetData(), oldCache.GetSize(), source, 2.0f));
+	ObjFile reloaded = ObjFile::LoadCached(fileName, cacheName, 2.0f);
+	CHECK(reloaded.GetTriangles().size() == 2);
+
+	// A cache that cannot be written does not fail the load:
+	ObjFile uncached = ObjFile::LoadCached(fileName, "TestObjFileCacheMissingDirectory/cache", 2.0f);
+	CHECK(uncached.GetTriangles().size() == 2);
+
+	std::remove(fileName.c_str());
+	std::remove(cacheName.c_str());
+}
+
+TEST_CASE("TestObjFileCalculateNormals")
+{
+	// Large triangle facing +z and small one facing +y, sharing the first vertex at right angles:
+	const std::string text =
+			"v 0 0 0\n"
+			"v 10 0 0\n"
+			"v 0 10 0\n"
+			"v 0 0 1\n"
+			"v 1 0 0\n"
+			"v 5 5 5\n" // Unreferenced
+			"vn 1 0 0\n"
+			"g g\n"
+			"f 1//1 2//1 3//1\n"
+			"f 1 4 5\n";
+
+	auto normalOfFirstVertex = [&](ObjNormalWeighting weighting)
+	{
+		ObjFile obj(text);
+		obj.CalculateNormals(weighting);
+		REQUIRE(obj.GetNormals().size() == 6);
+		CHECK(obj.GetNormals()[5] == Vector3(0, 0, 0));
+		CHECK(obj.GetTriangles()[1].normalIndices == obj.GetTriangles()[1].vertexIndices);
+		CHECK(obj.GetVertexGroups()[0].hasNormals);
+		return obj.GetNormals()[0];
+	};
+
+	const float s = std::sqrt(0.5f);
+	CHECK_THAT(normalOfFirstVertex(ObjNormalWeighting::kUniform), EqualsApprox(Vector3(0, s, s), 1e-6, 1e-6));
+	CHECK_THAT(normalOfFirstVertex(ObjNormalWeighting::kAngle), EqualsApprox(Vector3(0, s, s), 1e-6, 1e-6));
+	CHECK_THAT(normalOfFirstVertex(ObjNormalWeighting::kArea), EqualsApprox(Vector3(0, 0.5f, 50).Normalized(), 1e-6, 1e-6));
+
+	// Fan of more than 255 triangles around one vertex:
+	std::ostringstream fan;
+	fan << "v 0 0 0\ng fan\n";
+	const int kSegments = 300;
+	for(int i = 0; i < kSegments; ++i)
+	{
+		const float angle = 2 * 3.14159265f * i / kSegments;
+		fan << "v " << std::cos(angle) << ' ' << std::sin(angle) << " 0\n";
+	}
+	for(int i = 0; i < kSegments; ++i)
+		fan << "f 1 " << i + 2 << ' ' << (i + 1) % kSegments + 2 << '\n';
+	ObjFile fanObj(fan.str());
+	fanObj.CalculateNormals();
+	CHECK_THAT(fanObj.GetNormals()[0], EqualsApprox(Vector3(0, 0, 1), 1e-5, 1e-5));
+	CHECK_THAT(fanObj.GetNormals()[1], EqualsApprox(Vector3(0, 0, 1), 1e-5, 1e-5));
+
+	// Multi-threaded calculation gives identical results:
+	std::ostringstream grid;
+	const int kSize = 300;
+	for(int y = 0; y <= kSize; ++y)
+	{
+		for(int x = 0; x <= kSize; ++x)
+			grid << "v " << x << ' ' << y << ' ' << std::sin(x * 0.1f) * std::cos(y * 0.07f) << '\n';
+	}
+	grid << "g grid\n";
+	for(int y = 0; y < kSize; ++y)
+	{
+		for(int x = 0; x < kSize; ++x)
+		{
+			const int i = y * (kSize + 1) + x + 1;
+			const int j = i + kSize + 1;
+			if(x % 2)
+				grid << "f " << i << ' ' << i + 1 << ' ' << j + 1 << ' ' << j << '\n';
+			else
+				grid << "f " << i << ' ' << i + 1 << ' ' << j + 1 << "\nf " << i << ' ' << j + 1 << ' ' << j << '\n';
+		}
+	}
+	const ObjFile32 gridObj(grid.str());
+	TaskDispatcher dispatcher;
+	for(auto weighting: {ObjNormalWeighting::kUniform, ObjNormalWeighting::kArea, ObjNormalWeighting::kAngle})
+	{
+		ObjFile32 serial = gridObj;
+		serial.CalculateNormals(weighting);
+		ObjFile32 parallel = gridObj;
+		parallel.CalculateNormals(dispatcher, weighting);
+		CHECK(serial.GetNormals() == parallel.GetNormals());
+		CHECK(std::abs(serial.GetNormals()[12345].Length() - 1) < 1e-5f);
+	}
+}
+
+TEST_CASE("TestObjFileToMeshSet")
+{
+	std::ostringstream text;
+	for(int i = 0; i < 2000; ++i)
+	{
+		text << "v " << i << ' ' << i % 7 << " 0\n";
+		text << "vt " << i * 0.001f << " 0\n";
+		text << "vn 0 0 1\n";
+	}
+	for(int group = 0; group < 20; ++group)
+	{
+		text << "g group" << group << "\nusemtl material" << group % 3 << '\n';
+		for(int i = group * 90 + 1; i < group * 90 + 100; ++i)
+		{
+			if(group % 2)
+				text << "f " << i << ' ' << i + 1 << ' ' << i + 2 << ' ' << i + 3 << '\n';
+			else
+				text << "f " << i << '/' << i << '/' << i << ' ' << i + 1 << '/' << i << '/' << i << ' ' << i + 2 << "/1/1\n";
+		}
+	}
+	text << "g empty\n";
+	const ObjFile obj(text.str());
+	REQUIRE(obj.GetVertexGroups().size() == 21);
+
+	MeshSet serial = ObjFileUtils::ObjToMeshSet(obj);
+	TaskDispatcher dispatcher;
+	MeshSet parallel = ObjFileUtils::ObjToMeshSet(obj, dispatcher);
+	REQUIRE(serial.size() == 21);
+	REQUIRE(parallel.size() == 21);
+
+	for(size_t i = 0; i < serial.size(); ++i)
+	{
+		auto& group = obj.GetVertexGroups()[i];
+		std::vector<uint32_t> indices;
+		std::vector<Vector3> positions, normals;
+		std::vector<Vector2> uvs;
+		ObjFileUtils::ObjVertexGroupBuffers(obj, group, indices, positions, normals, uvs);
+
+		CHECK(serial[i].GetIndices() == indices);
+		CHECK(parallel[i].GetIndices() == indices);
+		CHECK(serial[i].GetNumVertices() == positions.size());
+		CHECK(parallel[i].GetNumVertices() == positions.size());
+		CHECK(parallel[i].GetMaterial() == group.material);
+		CHECK(parallel[i].GetAttributes().count(VertexAttributeInfo::kNormal) == (group.hasNormals ? 1 : 0));
+		CHECK(parallel[i].GetAttributes().count(VertexAttributeInfo::kTextureCoords) == (group.hasTexCoords ? 1 : 0));
+	}
+	CHECK(serial[20].GetIndices().empty());
+}
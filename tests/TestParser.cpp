@@ -26,6 +26,8 @@ SOFTWARE.
 #include <catch2/catch_test_macros.hpp>
 #include <molecular/util/Parser.h>
 
+#include <vector>
+
 using namespace molecular::util::Parser;
 
 TEST_CASE("TestParser")
@@ -108,3 +110,29 @@ TEST_CASE_METHOD(ParserTest, "ParserTest1")
 	CHECK(2 == mIntegerCalled);
 	CHECK(1 == mRealCalled);
 }
+
+struct ParserValueTest
+{
+	void ParserValue(int action, double value)
+	{
+		CHECK(action == 7);
+		values.push_back(value);
+	}
+
+	std::vector<double> values;
+};
+
+TEST_CASE_METHOD(ParserValueTest, "ParserTestRealValue")
+{
+	const char text[] = "0.1,-45.239e10,7";
+	const char* begin = text;
+	const char* end = text + sizeof(text) - 1;
+
+	typedef Concatenation<RealValue<7>, Repetition<Concatenation<Char<','>, RealValue<7> > > > List;
+	CHECK(List::Parse(begin, end, this));
+	CHECK(begin == end);
+	REQUIRE(values.size() == 3);
+	CHECK(values[0] == 0.1);
+	CHECK(values[1] == -45.239e10);
+	CHECK(values[2] == 7.0);
+}
@@ -26,6 +26,7 @@ SOFTWARE.
 #include <catch2/catch_test_macros.hpp>
 #include <molecular/util/StringUtils.h>
 #include <iostream>
+#include <limits>
 
 using namespace Catch;
 using Catch::Matchers::Equals;
@@ -42,6 +43,43 @@ TEST_CASE("TestScanF")
 	CHECK(345 == c);
 }
 
+TEST_CASE("TestParseNumber")
+{
+	const char text[] = "-12.5e-1 +3 0.1 1e-60 -1e60 2147483648 1e x";
+	const char* it = text;
+	const char* end = text + sizeof(text) - 1;
+	float f = 0;
+	double d = 0;
+	int32_t i = 0;
+
+	CHECK(StringUtils::ParseNumber(it, end, f));
+	CHECK(f == -1.25f);
+	CHECK(StringUtils::ParseNumber(++it, end, i));
+	CHECK(i == 3);
+	const char* number = ++it;
+	CHECK(StringUtils::ParseNumber(it, end, f));
+	CHECK(f == 0.1f); // Correctly rounded
+	CHECK(StringUtils::ParseNumber(number, end, d));
+	CHECK(d == 0.1);
+	CHECK(number == it);
+	CHECK(StringUtils::ParseNumber(++it, end, f));
+	CHECK(f == 0.0f);
+	CHECK(StringUtils::ParseNumber(++it, end, f));
+	CHECK(f == -std::numeric_limits<float>::infinity());
+	CHECK(*it == ' ');
+	number = ++it;
+	CHECK_FALSE(StringUtils::ParseNumber(it, end, i)); // Overflow
+	CHECK(it == number);
+	CHECK(StringUtils::ParseNumber(it, end, d));
+	CHECK(d == 2147483648.0);
+	CHECK(StringUtils::ParseNumber(++it, end, f));
+	CHECK(f == 1.0f);
+	CHECK(*it == 'e');
+	it += 2;
+	CHECK_FALSE(StringUtils::ParseNumber(it, end, f));
+	CHECK(*it == 'x');
+}
+
 TEST_CASE("TestEndsWith")
 {
 	CHECK(StringUtils::EndsWith("blablalaber", "aber") == true);